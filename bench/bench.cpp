@@ -0,0 +1,275 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <fluke.hpp>
+
+
+/*
+	Benchmark harness for fluke.
+
+	This runs fluke's window management code in-process against a real
+	X server (usually Xvfb, see `bench/run.sh` and `make bench`), spawns
+	a number of dummy client windows from a second connection and then calls
+	actions directly, measuring:
+
+	- latency: time from calling the action until the X server has
+	  processed every request it made.
+
+	- requests: number of X requests the action sent.
+
+	- round trips: number of times the action blocked waiting for a reply,
+	  as counted by `fluke::profiler`.
+
+	Results are appended to a CSV file so that runs can be diffed.
+
+	usage:
+		fluke_bench <clients> <iterations> <output.csv>
+*/
+
+
+namespace {
+	using clock_type = std::chrono::steady_clock;
+
+
+	// Actions we benchmark, `i` is the iteration number which lets
+	// benchmarks alternate arguments.
+	struct Benchmark {
+		const char* name;
+		void(*func)(fluke::Connection&, size_t);
+	};
+
+	constexpr Benchmark benchmarks[] = {
+		{ "action_layout_masterslave", [] (fluke::Connection& conn, size_t) {
+			fluke::action_layout_masterslave(conn, fluke::MASTER_LEFT, 60);
+		} },
+
+		{ "action_layout_stacked", [] (fluke::Connection& conn, size_t) {
+			fluke::action_layout_stacked(conn, fluke::STACK_VERTICAL);
+		} },
+
+		{ "action_layout_monocle", [] (fluke::Connection& conn, size_t) {
+			fluke::action_layout_monocle(conn);
+		} },
+
+		{ "action_layout_grid", [] (fluke::Connection& conn, size_t) {
+			fluke::action_layout_grid(conn);
+		} },
+
+		{ "action_layout_masterslave_all", [] (fluke::Connection& conn, size_t) {
+			fluke::action_layout_masterslave_all(conn, fluke::MASTER_LEFT, 60);
+		} },
+
+		{ "action_focus_dir", [] (fluke::Connection& conn, size_t i) {
+			fluke::action_focus_dir(conn, i % 2 == 0 ? fluke::FOCUS_RIGHT : fluke::FOCUS_LEFT);
+		} },
+
+		{ "action_focus", [] (fluke::Connection& conn, size_t i) {
+			fluke::action_focus(conn, i % 2 == 0 ? fluke::FOCUS_NEXT : fluke::FOCUS_PREV);
+		} },
+
+		{ "action_snap", [] (fluke::Connection& conn, size_t i) {
+			fluke::action_snap(conn, i % 2 == 0 ? fluke::SNAP_SIDE_LEFT : fluke::SNAP_SIDE_RIGHT);
+		} },
+	};
+
+
+
+	// Returns the sequence number of the request we are about to send.
+	// This sends a NoOperation request so it costs one request.
+	unsigned next_sequence(fluke::Connection& conn) {
+		return xcb_no_operation(conn).sequence;
+	}
+
+
+	// Total number of blocking round trips recorded by the profiler.
+	size_t total_stalls() {
+		size_t stalls = 0;
+
+		for (const auto& [key, entry]: fluke::profiler)
+			stalls += entry.stalls;
+
+		return stalls;
+	}
+
+
+	// Handle events until `done` returns true. Returns false if it takes
+	// longer than a few seconds.
+	template <typename F>
+	bool pump_events(fluke::Connection& conn, const int randr_base, F&& done) {
+		const auto deadline = clock_type::now() + std::chrono::seconds{10};
+
+		conn.flush();
+
+		while (not done()) {
+			if (xcb_connection_has_error(conn) != 0 or clock_type::now() > deadline)
+				return false;
+
+			if (auto event = fluke::Event{xcb_poll_for_event(conn), &std::free}) {
+				fluke::handle_event(conn, randr_base, std::move(event));
+				continue;
+			}
+
+			conn.flush();
+			std::this_thread::sleep_for(std::chrono::microseconds{100});
+		}
+
+		conn.flush();
+		return true;
+	}
+
+
+	// Wait for the server to catch up and handle all resulting events
+	// so that the window cache is up to date before the next iteration.
+	void settle(fluke::Connection& conn, const int randr_base) {
+		for (int pass = 0; pass < 2; ++pass) {
+			conn.sync();
+
+			while (auto event = fluke::Event{xcb_poll_for_event(conn), &std::free})
+				fluke::handle_event(conn, randr_base, std::move(event));
+		}
+	}
+
+
+	// Get the value at percentile `p` (0-100) of a sorted vector.
+	template <typename T>
+	T percentile(const std::vector<T>& sorted, const size_t p) {
+		return sorted.at(std::min(sorted.size() - 1, (sorted.size() * p) / 100));
+	}
+}
+
+
+
+int main(int argc, char* argv[]) {
+	if (argc != 4) {
+		tinge::errorln("usage: ", argv[0], " <clients> <iterations> <output.csv>");
+		return EXIT_FAILURE;
+	}
+
+	const auto clients = std::strtoul(argv[1], nullptr, 10);
+	const auto iterations = std::strtoul(argv[2], nullptr, 10);
+	const std::string output = argv[3];
+
+	if (clients == 0 or iterations == 0) {
+		tinge::errorln("clients and iterations must be greater than zero!");
+		return EXIT_FAILURE;
+	}
+
+
+	// Set ourselves up as the window manager, this mirrors `main.cpp`
+	// without the hooks, keybindings and signal handlers.
+	fluke::Connection conn;
+
+	if (xcb_connection_has_error(conn) != 0) {
+		tinge::errorln("cannot connect to the X server!");
+		return EXIT_FAILURE;
+	}
+
+	const int randr_base = xcb_get_extension_data(conn, &xcb_randr_id)->first_event;
+	fluke::randr_select_input(conn, conn.root(), fluke::XCB_RANDR_EVENTS);
+	fluke::build_display_cache(conn);
+
+	fluke::change_window_attributes(conn, conn.root(), XCB_CW_EVENT_MASK, fluke::XCB_WINDOWMANAGER_EVENTS);
+	fluke::build_window_cache(conn);
+	conn.sync();
+
+
+	// Spawn dummy clients from their own connection.
+	tinge::noticeln("spawning ", clients, " clients.");
+
+	const auto client_conn = std::unique_ptr<xcb_connection_t, decltype(&xcb_disconnect)>{
+		xcb_connect(nullptr, nullptr), &xcb_disconnect
+	};
+
+	const auto screen = xcb_setup_roots_iterator(xcb_get_setup(client_conn.get())).data;
+
+	for (size_t i = 0; i < clients; ++i) {
+		const xcb_window_t win = xcb_generate_id(client_conn.get());
+
+		xcb_create_window(
+			client_conn.get(), XCB_COPY_FROM_PARENT, win, screen->root,
+			0, 0, 100, 100, 0,
+			XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, 0, nullptr
+		);
+
+		xcb_map_window(client_conn.get(), win);
+	}
+
+	xcb_flush(client_conn.get());
+
+
+	// Wait for the window manager to map all of the clients.
+	const bool mapped = pump_events(conn, randr_base, [&] {
+		return fluke::get_mapped_windows(conn).size() >= clients;
+	});
+
+	if (not mapped) {
+		tinge::errorln("timed out waiting for clients to be mapped!");
+		return EXIT_FAILURE;
+	}
+
+	settle(conn, randr_base);
+
+
+	// Write a header if the file is new.
+	const bool new_file = not std::ifstream{output}.good();
+	std::ofstream out{output, std::ios::app};
+
+	if (new_file)
+		out << "clients,action,iterations,p50_us,p90_us,p99_us,max_us,requests,round_trips\n";
+
+
+	for (const auto& [name, func]: benchmarks) {
+		std::vector<uint64_t> latencies;
+		latencies.reserve(iterations);
+
+		size_t requests = 0;
+		size_t round_trips = 0;
+
+		for (size_t i = 0; i < iterations; ++i) {
+			const auto seq_before = next_sequence(conn);
+			const auto stalls_before = total_stalls();
+			const auto start = clock_type::now();
+
+			func(conn, i);
+			conn.sync();
+
+			const auto end = clock_type::now();
+
+			// Don't count the NoOperation request or the request sent by `sync`.
+			requests += next_sequence(conn) - seq_before - 2;
+			round_trips += total_stalls() - stalls_before;
+
+			latencies.emplace_back(static_cast<uint64_t>(
+				std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+			));
+
+			settle(conn, randr_base);
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+
+		tinge::successln(
+			name, ": p50 ", percentile(latencies, 50), "us, p99 ", percentile(latencies, 99),
+			"us, ", double(requests) / double(iterations), " requests, ",
+			double(round_trips) / double(iterations), " round trips"
+		);
+
+		out <<
+			clients << ',' <<
+			name << ',' <<
+			iterations << ',' <<
+			percentile(latencies, 50) << ',' <<
+			percentile(latencies, 90) << ',' <<
+			percentile(latencies, 99) << ',' <<
+			latencies.back() << ',' <<
+			double(requests) / double(iterations) << ',' <<
+			double(round_trips) / double(iterations) << '\n';
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env sh
+
+# Start a private Xvfb server and run the benchmark harness against it for
+# a number of different client counts.
+#
+# If the fluke binary is given, a session is first recorded against Xvfb
+# and then replayed without it to make sure traces still replay.
+#
+# usage: bench/run.sh <fluke_bench binary> <output.csv> [fluke binary]
+#
+# Environment:
+#   BENCH_DISPLAY     display number to use for Xvfb (default :99)
+#   BENCH_CLIENTS     client counts to test (default "10 100 1000")
+#   BENCH_ITERATIONS  iterations per action (default 50)
+
+set -e
+
+BENCH="$1"
+OUTPUT="$2"
+FLUKE="$3"
+
+BENCH_DISPLAY="${BENCH_DISPLAY:-:99}"
+BENCH_CLIENTS="${BENCH_CLIENTS:-10 100 1000}"
+BENCH_ITERATIONS="${BENCH_ITERATIONS:-50}"
+
+if [ -z "$BENCH" ] || [ -z "$OUTPUT" ]; then
+	echo "usage: $0 <fluke_bench binary> <output.csv> [fluke binary]" >&2
+	exit 1
+fi
+
+command -v Xvfb >/dev/null || { echo "Xvfb not found!" >&2; exit 1; }
+
+start_xvfb() {
+	Xvfb "$BENCH_DISPLAY" -screen 0 1920x1080x24 -nolisten tcp >/dev/null 2>&1 &
+	XVFB_PID=$!
+	trap 'kill $XVFB_PID 2>/dev/null' EXIT INT TERM
+
+	# Wait for the server to accept connections.
+	tries=0
+	until [ -e "/tmp/.X11-unix/X${BENCH_DISPLAY#:}" ]; do
+		tries=$((tries + 1))
+		[ $tries -gt 50 ] && { echo "Xvfb did not start!" >&2; exit 1; }
+		sleep 0.1
+	done
+}
+
+stop_xvfb() {
+	kill $XVFB_PID
+	wait $XVFB_PID 2>/dev/null || true
+}
+
+rm -f "$OUTPUT"
+
+# Record a short session and replay it, the replay must finish on its own
+# and in sync with the trace.
+if [ -n "$FLUKE" ]; then
+	TRACE="$(dirname "$OUTPUT")/smoke.trace"
+	rm -f "$TRACE"
+
+	start_xvfb
+
+	DISPLAY="$BENCH_DISPLAY" "$FLUKE" --record "$TRACE" >/dev/null 2>&1 &
+	FLUKE_PID=$!
+	sleep 1
+
+	# Give it a few windows to manage if we have something to show.
+	if command -v xclock >/dev/null; then
+		DISPLAY="$BENCH_DISPLAY" xclock &
+		DISPLAY="$BENCH_DISPLAY" xclock &
+		sleep 1
+	fi
+
+	kill -TERM $FLUKE_PID
+	wait $FLUKE_PID 2>/dev/null || true
+
+	stop_xvfb
+
+	if ! timeout 30 "$FLUKE" --replay "$TRACE" >/dev/null 2>&1; then
+		echo "replaying '$TRACE' failed!" >&2
+		exit 1
+	fi
+
+	echo "record/replay smoke run passed"
+fi
+
+for clients in $BENCH_CLIENTS; do
+	# Use a fresh server for each run so that results don't depend on
+	# windows left over from the previous run.
+	start_xvfb
+
+	DISPLAY="$BENCH_DISPLAY" "$BENCH" "$clients" "$BENCH_ITERATIONS" "$OUTPUT"
+
+	stop_xvfb
+done
+
+echo "results written to $OUTPUT"
@@ -0,0 +1,236 @@
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cinttypes>
+#include <tinge.hpp>
+#include <structures/ipc.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <sys/wait.h>
+}
+
+
+/*
+	Run a fluke command or query over the control socket.
+
+	Actions take integer arguments, enums are passed by their value (for
+	example `flukec focus_dir 0` focuses left). Queries print one line per
+	record. `flukec commands` lists everything fluke understands.
+
+	The exit status is non-zero if fluke couldn't be reached or rejected
+	the request.
+
+	usage:
+		flukec <command> [args...]
+
+	example:
+		flukec workspace_change 2
+		flukec layout_masterslave 0 60
+		flukec windows
+		flukec children
+*/
+
+
+namespace {
+	int connect_to_fluke() {
+		const auto path = fluke::runtime_path(".socket");
+
+		sockaddr_un addr{};
+		addr.sun_family = AF_UNIX;
+
+		if (path.size() >= sizeof(addr.sun_path))
+			return -1;
+
+		std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+		const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+		if (fd == -1)
+			return -1;
+
+		if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == -1) {
+			close(fd);
+			return -1;
+		}
+
+		return fd;
+	}
+
+
+	// Records in the reply are copied out since the buffer has no alignment guarantees.
+	template <typename T>
+	T record_at(const std::byte* records, const size_t i) {
+		T record;
+		std::memcpy(&record, records + i * sizeof(T), sizeof(T));
+		return record;
+	}
+
+
+	size_t record_size(const fluke::ipc::Kind kind) {
+		using namespace fluke::ipc;
+
+		switch (kind) {
+			case Kind::windows:  return sizeof(WindowRecord);
+			case Kind::displays: return sizeof(DisplayRecord);
+			case Kind::commands: return sizeof(CommandRecord);
+			case Kind::children: return sizeof(ChildRecord);
+			case Kind::none:     return 0;
+		}
+
+		return 0;
+	}
+
+
+	void print_records(const fluke::ipc::ReplyHeader& header, const std::byte* records) {
+		using namespace fluke::ipc;
+
+		for (size_t i = 0; i < header.count; ++i) {
+			switch (header.kind) {
+				case Kind::windows: {
+					const auto r = record_at<WindowRecord>(records, i);
+
+					std::printf(
+						"0x%08" PRIx32 " %d %d %u %u", r.win,
+						static_cast<int>(r.x), static_cast<int>(r.y),
+						static_cast<unsigned>(r.w), static_cast<unsigned>(r.h)
+					);
+
+					if (r.workspace != no_workspace)
+						std::printf(" workspace=0x%" PRIx32 ":%" PRIu32, r.crtc, r.workspace);
+
+					std::printf(
+						"%s%s%s%s\n",
+						r.mapped     ? " mapped"     : "",
+						r.ignored    ? " ignored"    : "",
+						r.hidden     ? " hidden"     : "",
+						r.scratchpad ? " scratchpad" : ""
+					);
+				} break;
+
+				case Kind::displays: {
+					const auto r = record_at<DisplayRecord>(records, i);
+
+					std::printf(
+						"0x%08" PRIx32 " %d %d %u %u %.2fHz workspace=%" PRIu32 "%s\n", r.crtc,
+						static_cast<int>(r.x), static_cast<int>(r.y),
+						static_cast<unsigned>(r.w), static_cast<unsigned>(r.h),
+						r.refresh ? 1e9 / static_cast<double>(r.refresh) : 0.0,
+						r.workspace,
+						r.tiled ? " tiled" : ""
+					);
+				} break;
+
+				case Kind::commands: {
+					auto r = record_at<CommandRecord>(records, i);
+					r.name[max_name - 1] = '\0';
+
+					std::printf("%s %" PRIu32 "\n", r.name, r.argc);
+				} break;
+
+				case Kind::children: {
+					auto r = record_at<ChildRecord>(records, i);
+					r.name[max_name - 1] = '\0';
+
+					std::printf("%" PRId32 " %s", r.pid, r.name);
+
+					if (r.running)
+						std::printf(" running\n");
+
+					else if (WIFSIGNALED(r.status))
+						std::printf(" signal=%d\n", WTERMSIG(r.status));
+
+					else
+						std::printf(" exit=%d\n", WEXITSTATUS(r.status));
+				} break;
+
+				case Kind::none: break;
+			}
+		}
+	}
+}
+
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 or static_cast<size_t>(argc - 2) > fluke::ipc::max_args) {
+		tinge::errorln("usage: ", argv[0], " <command> [up to ", fluke::ipc::max_args, " args...]");
+		return EXIT_FAILURE;
+	}
+
+	if (std::strlen(argv[1]) >= fluke::ipc::max_name) {
+		tinge::errorln("command name '", argv[1], "' is too long!");
+		return EXIT_FAILURE;
+	}
+
+	auto request = fluke::ipc::make_request(argv[1]);
+	request.argc = static_cast<uint32_t>(argc - 2);
+
+	for (int i = 2; i < argc; ++i) {
+		char* end = nullptr;
+		errno = 0;
+
+		const long value = std::strtol(argv[i], &end, 0);
+
+		if (errno != 0 or end == argv[i] or *end != '\0' or value < INT32_MIN or value > INT32_MAX) {
+			tinge::errorln("argument '", argv[i], "' is not an integer!");
+			return EXIT_FAILURE;
+		}
+
+		request.args[i - 2] = static_cast<int32_t>(value);
+	}
+
+
+	const int fd = connect_to_fluke();
+
+	if (fd == -1) {
+		tinge::errorln("cannot connect to fluke at '", fluke::runtime_path(".socket"), "'!");
+		return EXIT_FAILURE;
+	}
+
+	if (send(fd, &request, sizeof(request), MSG_NOSIGNAL) != sizeof(request)) {
+		tinge::errorln("cannot send request!");
+		close(fd);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::byte> buffer(fluke::ipc::max_reply);
+	const auto length = recv(fd, buffer.data(), buffer.size(), 0);
+
+	close(fd);
+
+	if (length < static_cast<ssize_t>(sizeof(fluke::ipc::ReplyHeader))) {
+		tinge::errorln("no reply from fluke!");
+		return EXIT_FAILURE;
+	}
+
+	fluke::ipc::ReplyHeader header;
+	std::memcpy(&header, buffer.data(), sizeof(header));
+
+	if (header.version != fluke::ipc::version) {
+		tinge::errorln("fluke speaks protocol version ", header.version, ", we speak ", fluke::ipc::version, "!");
+		return EXIT_FAILURE;
+	}
+
+	if (header.status != fluke::ipc::Status::ok) {
+		const auto status = static_cast<size_t>(header.status);
+		const bool known = status < std::size(fluke::ipc::STATUS_STRINGS);
+
+		tinge::errorln("'", argv[1], "': ", known ? fluke::ipc::STATUS_STRINGS[status] : "unknown error", "!");
+		return EXIT_FAILURE;
+	}
+
+	if (static_cast<size_t>(length) < sizeof(header) + header.count * record_size(header.kind)) {
+		tinge::errorln("reply from fluke is truncated!");
+		return EXIT_FAILURE;
+	}
+
+	print_records(header, buffer.data() + sizeof(header));
+
+	return EXIT_SUCCESS;
+}
@@ -4,6 +4,13 @@ STD=c++17
 BUILD_DIR=build
 TARGET=fluke
 
+CLIENT_SRC=client/flukec.cpp
+CLIENT_TARGET=flukec
+
+BENCH_SRC=bench/bench.cpp
+BENCH_TARGET=fluke_bench
+BENCH_OUTPUT=$(BUILD_DIR)/bench.csv
+
 
 # Include & Link
 INCS=-I. -Isrc/ -Imodules/tinge/
@@ -57,4 +64,6 @@ endif
 
 # Accumulate all flags
 COMPILE_COMMAND=$(CXX) $(PROGRAM_LDFLAGS) -std=$(STD) $(PROGRAM_WARNINGS) -m64 $(PROGRAM_CXXFLAGS) $(INCS) $(PROGRAM_CPPFLAGS) -o $(BUILD_DIR)/$(TARGET) $(SRC)
+CLIENT_COMPILE_COMMAND=$(CXX) $(LDFLAGS) -std=$(STD) $(PROGRAM_WARNINGS) -m64 $(PROGRAM_CXXFLAGS) $(INCS) $(PROGRAM_CPPFLAGS) -o $(BUILD_DIR)/$(CLIENT_TARGET) $(CLIENT_SRC)
+BENCH_COMPILE_COMMAND=$(CXX) $(PROGRAM_LDFLAGS) -std=$(STD) $(PROGRAM_WARNINGS) -m64 $(PROGRAM_CXXFLAGS) $(INCS) $(PROGRAM_CPPFLAGS) -o $(BUILD_DIR)/$(BENCH_TARGET) $(BENCH_SRC)
 
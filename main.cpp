@@ -1,48 +1,51 @@
 #include <iostream>
 #include <array>
 #include <cstdlib>
-#include <csignal>
-#include <csetjmp>
+#include <chrono>
+#include <string_view>
 #include <fluke.hpp>
 
 
-std::jmp_buf exit_jump;     // This is used to jump back to main after a signal is handled.
-int status = EXIT_SUCCESS;  // Exit status for signal handler.
+int main(int argc, char* argv[]) {
+	// Parse arguments.
+	// `--record <file>` writes a trace of everything we receive from X to a file.
+	// `--replay <file>` runs a recorded trace through the event handlers without an X server.
+	// `--restore <fd>` is passed to ourselves on restart, the snapshot is in the inherited file.
+	const char* record_path = nullptr;
+	const char* replay_path = nullptr;
+	int restore_fd = -1;
 
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
 
-// Keyboard interrupt.
-inline void sigint(int) {
-	FLUKE_DEBUG_WARN("SIGINT")
-	std::longjmp(exit_jump, EXIT_FAILURE);
-}
-
+		if (arg == "--record" and i + 1 < argc)
+			record_path = argv[++i];
 
-// Terminate.
-inline void sigterm(int) {
-	FLUKE_DEBUG_WARN("SIGTERM")
-	std::longjmp(exit_jump, EXIT_FAILURE);
-}
+		else if (arg == "--replay" and i + 1 < argc)
+			replay_path = argv[++i];
 
+		else if (arg == "--restore" and i + 1 < argc)
+			restore_fd = std::atoi(argv[++i]);
 
-// Kill.
-[[noreturn]] inline void sigkill(int) {
-	FLUKE_DEBUG_ERROR("SIGKILL")
-	std::exit(EXIT_FAILURE);
-}
+		else {
+			tinge::errorln("usage: ", argv[0], " [--record <file> | --replay <file> | --restore <fd>]");
+			return EXIT_FAILURE;
+		}
+	}
 
 
+	// Map the trace before connecting, the stand-in connection is built from it.
+	fluke::Trace trace;
 
-int main() {
-	// Setup signals handlers.
-	FLUKE_DEBUG_SUCCESS("setting up signal handlers.")
-	std::signal(SIGINT, sigint);
-	std::signal(SIGTERM, sigterm);
-	std::signal(SIGKILL, sigkill);
+	if (replay_path and not trace.replay(replay_path)) {
+		tinge::errorln("cannot read trace '", replay_path, "'!");
+		return EXIT_FAILURE;
+	}
 
 
 	// Connect to X.
 	FLUKE_DEBUG_SUCCESS("connecting to X server.")
-	fluke::Connection conn;
+	fluke::Connection conn = replay_path ? fluke::Connection{std::move(trace)} : fluke::Connection{};
 
 
 	// Setup the randr extension to allow us to recieve display change events.
@@ -51,32 +54,153 @@ int main() {
 	const auto randr_ext = xcb_get_extension_data(conn, &xcb_randr_id);
 	const auto randr_base = randr_ext->first_event;
 
+	if (record_path) {
+		FLUKE_DEBUG_SUCCESS("recording trace to '", record_path, "'.")
+
+		const auto setup = xcb_get_setup(conn);
+
+		// The keyboard mapping is needed to build the stand-in connection
+		// on replay, ask for the same range `xcb_key_symbols_alloc` does.
+		const auto keymap = fluke::get(conn, fluke::get_keyboard_mapping(
+			conn, setup->min_keycode, static_cast<uint8_t>(setup->max_keycode - setup->min_keycode + 1)
+		));
+
+		if (not conn.trace().record(record_path, setup, randr_ext, keymap.get())) {
+			tinge::errorln("cannot write trace '", record_path, "'!");
+			return EXIT_FAILURE;
+		}
+	}
+
 	fluke::randr_select_input(conn, conn.root(), fluke::XCB_RANDR_EVENTS);
 
 
+	// Wait on X, signals and timers together. Signals are read from a file
+	// by the event loop instead of interrupting us in a handler.
+	if (not replay_path) {
+		FLUKE_DEBUG_SUCCESS("setting up event loop.")
+
+		if (not conn.loop().open(xcb_get_file_descriptor(conn)))
+			tinge::errorln("cannot set up event loop, signals and timers won't be handled!");
+	}
+
+
+	// Let scripts run commands through the control socket. Commands would
+	// make requests which a replay of the trace knows nothing about.
+	if (conn.loop().is_open() and not record_path) {
+		const auto socket_path = fluke::runtime_path(".socket");
+
+		FLUKE_DEBUG_SUCCESS("listening on '", socket_path, "'.")
+
+		if (not conn.control().open(socket_path) or not conn.loop().watch(conn.control().fd()))
+			tinge::errorln("cannot listen on '", socket_path, "'!");
+	}
+
+
 	// Register to receive window manager events. Only one window manager can be active at one time.
 	FLUKE_DEBUG_SUCCESS("registering as a window manager.")
 	fluke::change_window_attributes(conn, conn.root(), XCB_CW_EVENT_MASK, fluke::XCB_WINDOWMANAGER_EVENTS);
 
 
+	// Fill the display and window caches and find the focused window in one go,
+	// from here on the caches are kept up to date by events.
+	FLUKE_DEBUG_SUCCESS("querying displays and windows.")
+
+	xcb_window_t focused = XCB_NONE;
+
+	// A snapshot left behind by the previous instance saves us asking about
+	// every window. Traces are never mixed with snapshots, a replay has to
+	// send exactly the requests that were recorded.
+	const bool use_snapshots = fluke::config::SNAPSHOT_ON_EXIT and not record_path and not replay_path;
+	const auto snapshot_path = fluke::snapshot_path();
+	fluke::Snapshot snapshot;
+	fluke::Snapshot::Identity identity{};
+
+	if (use_snapshots)
+		identity = fluke::snapshot_identity(conn);
+
+	if (restore_fd != -1) {
+		if (not snapshot.load(restore_fd))
+			tinge::errorln("cannot read snapshot handed over on restart!");
+
+		close(restore_fd);
+	}
+
+	else if (use_snapshots and snapshot.load(snapshot_path.c_str(), identity))
+		FLUKE_DEBUG_SUCCESS("restoring from snapshot '", snapshot_path, "'.")
+
+	{
+		fluke::Pipeline pipe{conn};
+
+		fluke::request_display_cache(pipe);
+
+		if (snapshot.loaded())
+			fluke::request_window_cache(pipe, snapshot);
+
+		else
+			fluke::request_window_cache(pipe);
+
+		// If no window is focused an error will be generated but we just ignore it.
+		pipe.send(fluke::get_input_focus(conn), [&focused] (auto&, fluke::GetInputFocusReply reply) {
+			if (reply)
+				focused = reply->focus;
+		});
+	}
+
+
 	// Gain control of windows which were already open before the window manager was started
 	// so that we can receive events for them.
 	FLUKE_DEBUG_SUCCESS("adopting orphaned windows.")
 
+	// Windows from the snapshot already have their borders, we only have to
+	// ask for their events again since our previous connection is gone.
+	if (snapshot.loaded()) {
+		fluke::restore_snapshot(conn, snapshot);
+
+		// The displays may have changed while no window manager was running.
+		fluke::fit_workspaces_to_displays(conn);
+		fluke::fit_tiling_to_displays(conn);
+
+		for (const auto& client: conn.windows()) {
+			if (conn.workspaces().contains(client.win) or conn.scratchpads().find(client.win) != fluke::Scratchpads::npos)
+				fluke::change_window_attributes(conn, client.win, XCB_CW_EVENT_MASK, fluke::XCB_WINDOW_EVENTS);
+		}
+
+		// Hidden windows are shown when we exit and are left hidden when
+		// we restart, hide whichever are showing and take them back into
+		// our save-set.
+		fluke::for_each_hidden_window(conn, [&conn] (xcb_window_t win) {
+			const auto client = conn.windows().find(win);
+
+			if (client and client->mapped) {
+				if (conn.workspaces().contains(win))
+					conn.workspaces().expect_unmap(win);
+
+				fluke::hide_window(conn, win);
+			}
+
+			else
+				fluke::change_save_set(conn, XCB_SET_MODE_INSERT, win);
+		});
+	}
+
 	// For every mapped window, tell it what events we wish to receive from it
 	// and also set the border colour and width of the window.
 	for (const xcb_window_t win: fluke::get_mapped_windows(conn)) {
+		if (conn.workspaces().contains(win) or conn.scratchpads().find(win) != fluke::Scratchpads::npos)
+			continue;
+
+		if (const auto client = conn.windows().find(win))
+			conn.workspaces().add(win, fluke::get_nearest_display(conn, client->rect).crtc);
+
 		fluke::change_window_attributes(conn, win, XCB_CW_EVENT_MASK, fluke::XCB_WINDOW_EVENTS);
 		fluke::configure_window(conn, win, XCB_CONFIG_WINDOW_BORDER_WIDTH, fluke::config::BORDER_SIZE);
 		fluke::change_window_attributes(conn, win, XCB_CW_BORDER_PIXEL, fluke::config::BORDER_COLOUR_INACTIVE);
 	}
 
 
-	// Get the window which currently has keyboard focus
-	// (if no window is focused an error will be generated but we just ignore it)
-	const xcb_window_t focused = fluke::get_focused_window(conn);
-
-	if (fluke::is_valid_window(conn, focused)) {
+	// Focus the window which had keyboard focus before we started. Windows
+	// restored from a snapshot are already focused and stacked the way they were.
+	if (not snapshot.loaded() and fluke::is_valid_window(conn, focused)) {
 		// Set the stacking mode, border width and border colour for the focused window.
 		fluke::configure_window(
 			conn, focused,
@@ -95,150 +219,78 @@ int main() {
 		fluke::register_keybindings(conn, fluke::config::keybindings);
 	}
 
+	FLUKE_DEBUG_SUCCESS("registering drag buttons.")
+	fluke::register_buttons(conn);
 
-	// Set jump point, when a signal handler gets activated, it will jump here.
-	if (status = setjmp(exit_jump); status) {
-		FLUKE_DEBUG_SUCCESS("signal caught.")
-		goto exit;
-	}
+
+	const auto loop_start = std::chrono::steady_clock::now();
+	int status = EXIT_SUCCESS;
 
 
 	FLUKE_DEBUG_SUCCESS("starting main event loop.")
 	fluke::on_launch(conn);
+	conn.flush();
 
-	while (true) {
-		conn.flush();
+	// Handle events in batches, every event which is already available is
+	// handled before we flush our requests and block for more events.
+	for (fluke::EventBatch batch; batch.fill(conn);) {
+		batch.dispatch(conn, randr_base);
 
-		// Get the next event and its type.
-		auto event = fluke::get_next_event(conn);
-		auto ev_type = fluke::get_event_type(event);
-		auto randr_ev_type = randr_base - ev_type;
+		// Only returns if the restart failed.
+		if (conn.restart_requested())
+			fluke::restart(conn, argv, fluke::config::keybindings);
 
-		// Check for errors.
-		if (xcb_connection_has_error(conn) != 0) {
-			tinge::errorln("cannot connect to the X server!");
-			break;
+		// Statistics were requested with SIGUSR1.
+		if (conn.loop().take_stats_request()) {
+			fluke::print_event_stats(conn);
+			fluke::print_request_stats();
 		}
+	}
 
-		if (not event) {
-			tinge::errorln("event returned nullptr, this shouldnt happen!");
-			continue;
-		}
-
-
-		// Handle all events.
-		switch (ev_type) {
-			case XCB_MOTION_NOTIFY:
-				fluke::event_motion_notify(conn,
-					fluke::event_cast<fluke::MotionNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_CONFIGURE_REQUEST:
-				fluke::event_configure_request(conn,
-					fluke::event_cast<fluke::ConfigureRequestEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_KEY_PRESS:
-				fluke::event_keypress(conn,
-					fluke::event_cast<fluke::KeyPressEvent>(std::move(event))
-				);
-				continue;
-
-			case 0:
-				fluke::event_error(conn,
-					fluke::event_cast<fluke::Error>(std::move(event))
-				);
-				continue;
-
-			case XCB_ENTER_NOTIFY:
-				fluke::event_enter_notify(conn,
-					fluke::event_cast<fluke::EnterNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_LEAVE_NOTIFY:
-				fluke::event_leave_notify(conn,
-					fluke::event_cast<fluke::LeaveNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_FOCUS_IN:
-				fluke::event_focus_in(conn,
-					fluke::event_cast<fluke::FocusInEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_FOCUS_OUT:
-				fluke::event_focus_out(conn,
-					fluke::event_cast<fluke::FocusOutEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_CREATE_NOTIFY:
-				fluke::event_create_notify(conn,
-					fluke::event_cast<fluke::CreateNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_DESTROY_NOTIFY:
-				fluke::event_destroy_notify(conn,
-					fluke::event_cast<fluke::DestroyNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_MAP_REQUEST:
-				fluke::event_map_request(conn,
-					fluke::event_cast<fluke::MapRequestEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_UNMAP_NOTIFY:
-				fluke::event_unmap_notify(conn,
-					fluke::event_cast<fluke::UnmapNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_PROPERTY_NOTIFY:
-				fluke::event_property_notify(conn,
-					fluke::event_cast<fluke::PropertyNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_CLIENT_MESSAGE:
-				fluke::event_client_message(conn,
-					fluke::event_cast<fluke::ClientMessageEvent>(std::move(event))
-				);
-				continue;
-		}
+	if (conn.loop().stopped()) {
+		FLUKE_DEBUG_SUCCESS("signal caught.")
+		status = conn.loop().status();
+	}
 
+	else if (conn.trace().replaying()) {
+		const auto& replayed = conn.trace();
+		const auto elapsed = std::chrono::steady_clock::now() - loop_start;
 
-		// Handle randr events, these checks are exhaustive so we
-		// do not need to check for unhandled randr events.
-		switch (randr_ev_type) {
-			case XCB_RANDR_SCREEN_CHANGE_NOTIFY:
-				fluke::event_randr_screen_change_notify(conn,
-					fluke::event_cast<fluke::RandrScreenChangeNotifyEvent>(std::move(event))
-				);
-				continue;
-
-			case XCB_RANDR_NOTIFY:
-				fluke::event_randr_notify(conn,
-					fluke::event_cast<fluke::RandrNotifyEvent>(std::move(event))
-				);
-				continue;
-		}
+		tinge::successln(
+			"replayed ", replayed.records_replayed(), " records spanning ",
+			replayed.replayed_ns() / 1'000'000, "ms of recorded time in ",
+			std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), "ms."
+		);
 
+		fluke::print_event_stats(conn);
+		fluke::print_request_stats();
 
-		// Warn about unhandled events.
-		FLUKE_DEBUG_WARN("unhandled event '", fluke::event_str[ev_type], "'!")
+		status = replayed.failed() ? EXIT_FAILURE : EXIT_SUCCESS;
 	}
 
-	exit:
+	else {
+		tinge::errorln("cannot connect to the X server!");
+	}
 
 	FLUKE_DEBUG_SUCCESS("exiting.")
+	FLUKE_DEBUG( fluke::print_event_stats(conn) )
+	FLUKE_DEBUG( fluke::print_request_stats() )
 	fluke::on_exit(conn);
 
+	// Whatever runs after us may not know about workspaces or scratchpads,
+	// show every window we were hiding. Our save-set does the same if we
+	// crash. The snapshot remembers where they belong.
+	if (not conn.trace().replaying()) {
+		fluke::for_each_hidden_window(conn, [&conn] (xcb_window_t win) {
+			fluke::map_window(conn, win);
+			conn.windows().set_mapped(win, true);
+		});
+
+		conn.flush();
+	}
+
+	if (use_snapshots and not fluke::save_snapshot(conn, snapshot_path.c_str(), identity))
+		tinge::errorln("cannot write snapshot '", snapshot_path, "'!");
+
 	return status;
 }
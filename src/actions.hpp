@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <type_traits>
+#include <vector>
 #include <fluke.hpp>
 
 namespace fluke {
@@ -27,7 +28,7 @@ namespace fluke {
 			return;
 
 		// Get geometry of focused window and calculate offsets for the new window rect.
-		auto [x, y, w, h] = fluke::as_rect(fluke::get(conn, fluke::get_geometry(conn, focused)));
+		auto [x, y, w, h] = fluke::get_window_rect(conn, focused);
 
 		x += x_amount;
 		y += y_amount;
@@ -44,12 +45,96 @@ namespace fluke {
 
 
 	// Change workspace
-	inline void action_workspace_change(fluke::Connection&) {
+	inline void action_workspace_change(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("WORKSPACE_CHANGE"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
+
+		const auto [crtc, rect, refresh] = fluke::get_hovered_display(conn);
+
+		if (crtc == XCB_NONE or index >= fluke::Workspaces::count)
+			return;
+
+		auto& workspaces = conn.workspaces();
+		const size_t current = workspaces.active(crtc);
 
+		if (index == current)
+			return;
+
+		// Everything we need is already known so this is a single burst of
+		// requests with no replies to wait on. The incoming windows are
+		// mapped first so that the display is never left empty.
+		const auto& incoming = workspaces.clients(crtc, index);
+		const auto& outgoing = workspaces.clients(crtc, current);
+
+		for (xcb_window_t win: incoming) {
+			fluke::map_window(conn, win);
+			conn.windows().set_mapped(win, true);
+		}
+
+		// Hidden windows leave the BSP tree, the incoming windows take
+		// their place once they are gone.
+		for (xcb_window_t win: outgoing) {
+			const auto client = conn.windows().find(win);
+
+			if (not client or not client->mapped)
+				continue;
+
+			fluke::untile_window(conn, win);
+
+			workspaces.expect_unmap(win);
+			fluke::hide_window(conn, win);
+		}
+
+		xcb_window_t previous = XCB_NONE;
+
+		for (xcb_window_t win: incoming) {
+			fluke::tile_window(conn, win, previous);
+			previous = win;
+		}
+
+		workspaces.activate(crtc, index);
+
+		// Focus whichever window was focused last on this workspace.
+		if (incoming.empty())
+			return;
+
+		const xcb_window_t last = incoming.back();
+
+		fluke::configure_window(conn, last, XCB_CONFIG_WINDOW_STACK_MODE, XCB_STACK_MODE_ABOVE);
+		fluke::set_input_focus(conn, XCB_INPUT_FOCUS_PARENT, last);
 	}
 
-	inline void action_workspace_send_to(fluke::Connection&) {
+	inline void action_workspace_send_to(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("WORKSPACE_SEND_TO"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
+
+		const xcb_window_t focused = fluke::get_focused_window(conn);
+		auto& workspaces = conn.workspaces();
+
+		if (not fluke::is_valid_window(conn, focused) or not workspaces.move(focused, index))
+			return;
+
+		// The window went to a workspace which isn't visible, hide it and
+		// focus the next window in line on this workspace.
+		fluke::untile_window(conn, focused);
+
+		workspaces.expect_unmap(focused);
+		fluke::hide_window(conn, focused);
 
+		const auto crtc = workspaces.display_of(focused);
+		const auto& remaining = workspaces.clients(crtc, workspaces.active(crtc));
+
+		if (remaining.empty())
+			return;
+
+		const xcb_window_t next = remaining.back();
+
+		fluke::configure_window(conn, next, XCB_CONFIG_WINDOW_STACK_MODE, XCB_STACK_MODE_ABOVE);
+		fluke::set_input_focus(conn, XCB_INPUT_FOCUS_PARENT, next);
 	}
 
 
@@ -57,24 +142,87 @@ namespace fluke {
 
 
 	// scratchpad
-	inline void action_scratchpad_show(fluke::Connection&) {
+	inline void action_scratchpad_show(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("SCRATCHPAD_SHOW"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
 
+		if (index < conn.scratchpads().size())
+			fluke::show_scratchpad(conn, index);
 	}
 
-	inline void action_scratchpad_hide(fluke::Connection&) {
+	inline void action_scratchpad_hide(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("SCRATCHPAD_HIDE"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
 
+		if (index < conn.scratchpads().size())
+			fluke::hide_scratchpad(conn, index);
 	}
 
-	inline void action_scratchpad_toggle(fluke::Connection&) {
+	inline void action_scratchpad_toggle(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("SCRATCHPAD_TOGGLE"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
 
+		if (index >= conn.scratchpads().size())
+			return;
+
+		if (conn.scratchpads()[index].visible)
+			fluke::hide_scratchpad(conn, index);
+
+		else
+			fluke::show_scratchpad(conn, index);
 	}
 
-	inline void action_scratchpad_add(fluke::Connection&) {
+	// Turn scratchpad `index` back into a normal window on the active workspace.
+	inline void action_scratchpad_remove(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("SCRATCHPAD_REMOVE"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
+
+		auto& pads = conn.scratchpads();
 
+		if (index >= pads.size() or pads[index].win == XCB_NONE)
+			return;
+
+		const auto [win, rect, launched, visible, show_on_claim, pid] = pads[index];
+		pads.release(index);
+
+		conn.workspaces().add(win, fluke::get_nearest_display(conn, rect).crtc);
+
+		if (not visible) {
+			fluke::map_window(conn, win);
+			conn.windows().set_mapped(win, true);
+		}
 	}
 
-	inline void action_scratchpad_remove(fluke::Connection&) {
+	// Turn the focused window into scratchpad `index`, the window which was
+	// there before goes back to being a normal window.
+	inline void action_scratchpad_add(fluke::Connection& conn, size_t index) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("SCRATCHPAD_ADD"),
+			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
+		)
+
+		auto& pads = conn.scratchpads();
+		const xcb_window_t focused = fluke::get_focused_window(conn);
+
+		if (index >= pads.size() or not fluke::is_valid_window(conn, focused) or pads.find(focused) != fluke::Scratchpads::npos)
+			return;
+
+		fluke::action_scratchpad_remove(conn, index);
+
+		// Scratchpads float above every workspace and aren't tiled.
+		conn.workspaces().remove(focused);
+		fluke::untile_window(conn, focused);
 
+		pads.claim(index, focused, fluke::get_window_rect(conn, focused));
+		pads[index].visible = true;
 	}
 
 
@@ -89,12 +237,12 @@ namespace fluke {
 			"' with arg(s) '", tinge::fg::make_yellow(index), "'"
 		)
 
-		auto displays = fluke::get_crtcs(conn);
+		const auto& displays = fluke::get_displays(conn);
 
 		if (std::make_unsigned_t<int>(index) >= displays.size())
 			return;
 
-		fluke::center_pointer_in_rect(conn, fluke::as_rect(displays.at(std::make_unsigned_t<int>(index))));
+		fluke::center_pointer_in_rect(conn, displays[std::make_unsigned_t<int>(index)].rect);
 	}
 
 
@@ -131,25 +279,6 @@ namespace fluke {
 		if (not fluke::is_valid_window(conn, focused))
 			return;
 
-		// Vector of all windows currently mapped.
-		const auto windows = fluke::get_mapped_windows(conn);
-
-		if (windows.size() <= 1)
-			return;
-
-		// Get the geometry of all mapped windows.
-		// We also want to find the index for the geometry of the focused
-		// specifically too.
-		decltype(windows)::size_type i = 0;
-
-		const auto geoms = fluke::dispatch_consume(conn, [&] (xcb_window_t win) {
-			if (win != focused)
-				i++;
-
-			return fluke::get_geometry( conn, win );
-		}, windows);
-
-
 		// Get the midpoint of each side of a rectangle.
 		const auto left_side   = [] (auto x, auto y, auto w, auto h) { return fluke::Point{ x,         y + h / 2 }; };
 		const auto right_side  = [] (auto x, auto y, auto w, auto h) { return fluke::Point{ x + w,     y + h / 2 }; };
@@ -158,7 +287,7 @@ namespace fluke {
 
 
 		// Get geometry of currently focused window.
-		const auto focused_rect = fluke::as_rect(geoms.at(i));
+		const auto focused_rect = fluke::get_window_rect(conn, focused);
 		const auto [fx, fy, fw, fh] = focused_rect;
 
 
@@ -171,48 +300,26 @@ namespace fluke {
 		}.at(std::make_unsigned_t<int>(dir));
 
 
-		// Store distances to windows and the associated window IDs.
-		std::vector<std::pair<xcb_window_t, int>> distances;
-		distances.reserve(windows.size());
-
-
-		// Loop over all windows and get the midpoint of all of their four sides.
-		// We get the point which is nearest to the focused window and
-		// add it to our `distances` vector.
-		for (const auto [win, geom]: fluke::zip(windows, geoms)) {
+		// Ask the spatial index for the mapped window whose center is nearest
+		// to the reference point on the focused window. Only windows which
+		// are present in the direction we wish to focus are considered.
+		// For example: if we are focusing to the right, we only consider windows
+		// which are to the right of the focused window.
+		const xcb_window_t nearest_win = conn.windows().index().nearest(fpoint, [focused, fpoint, dir] (xcb_window_t win, fluke::Point point) {
 			if (win == focused)
-				continue;
-
-			const auto point = fluke::get_rect_center(fluke::as_rect(geom));
-
+				return false;
 
-			// Check if the window we are currently checking is present in the direction
-			// we wish to focus.
-			// For example: if we are focusing to the right, we only consider windows
-			// which are to the right of the focused window.
-			if (not std::array{
+			return std::array{
 				point.x < fpoint.x,  // Left.
 				point.x > fpoint.x,  // Right.
 				point.y < fpoint.y,  // Top.
 				point.y > fpoint.y,  // Bottom.
-			}.at(std::make_unsigned_t<int>(dir))) {
-				continue;
-			}
-
-			// If the window is valid, calculate the distance between the reference
-			// point on the focused window to the point on the appropriate side of
-			// the window we are checking. Add it to the vector of distances.
-			distances.emplace_back(win, fluke::distance_abs(fpoint, point));
-		}
+			}.at(std::make_unsigned_t<int>(dir));
+		});
 
-		// Find window with nearest distance.
-		const auto nearest_win = std::min_element(
-			distances.begin(), distances.end(),
-
-			[] (const auto& a, const auto& b) {
-				return a.second < b.second;
-			}
-		)->first;
+		// There are no windows in this direction.
+		if (nearest_win == XCB_NONE)
+			return;
 
 		// Set input focus to new window.
 		fluke::configure_window(conn, nearest_win, XCB_CONFIG_WINDOW_STACK_MODE, XCB_STACK_MODE_ABOVE);
@@ -341,7 +448,7 @@ namespace fluke {
 		if (not fluke::is_valid_window(conn, focused))
 			return;
 
-		const auto focused_rect = fluke::as_rect(fluke::get(conn, fluke::get_geometry(conn, focused)));
+		const auto focused_rect = fluke::get_window_rect(conn, focused);
 
 		// Get usable screen area.
 		const auto [display_x, display_y, display_w, display_h] =
@@ -427,82 +534,97 @@ namespace fluke {
 
 
 	// Tiling
-	enum {
-		MASTER_LEFT,
-		MASTER_RIGHT,
-	};
-
-	constexpr const char* master_str[] = {
-		"MASTER_LEFT",
-		"MASTER_RIGHT",
-	};
-
 	inline void action_layout_masterslave(fluke::Connection& conn, int master_side, int master_size) {
 		FLUKE_DEBUG_NOTICE(
 			"action '", tinge::fg::make_yellow("LAYOUT_MASTERSLAVE"),
 			"' with arg(s) '", tinge::fg::make_yellow(master_str[master_side]), "'"
 		)
 
-		auto windows = fluke::get_mapped_windows_on_hovered_display(conn);
+		// Ask for the hovered display once, it is needed for both the
+		// windows and the layout.
+		const auto display_rect = fluke::get_hovered_display_rect(conn);
+
+		auto windows = fluke::get_mapped_windows_on_display(conn, display_rect);
 		if (windows.size() <= 1)
 			return;
 
-		// Get the rect of the display which contains the pointer and
-		// the usable display area.
-		const auto [display_x, display_y, display_w, display_h] =
-			fluke::get_adjusted_display_rect(fluke::get_hovered_display_rect(conn));
+		// The focused window becomes the master window.
+		const xcb_window_t focused = fluke::get_focused_window(conn);
 
+		std::vector<fluke::Placement> layout;
+		layout.reserve(windows.size());
 
-		// Get widths of master and slave windows.
-		const auto master_w = (display_w * master_size) / 100;
-		const auto slave_w = display_w - master_w;
+		for (auto win: windows)
+			layout.emplace_back(fluke::Placement{ win, fluke::Rect{} });
 
+		fluke::layout_masterslave(
+			layout,
+			fluke::get_adjusted_display_rect(display_rect),
+			focused, master_side, master_size
+		);
 
-		// Get the height that each slave window should be.
-		const float slave_h = float(display_h) / (windows.size() - 1);
-		float sliding_y = display_y;  // Keep track of Y position so we can stack slave windows.
+		// Resize and move the windows which aren't already in place.
+		fluke::apply_layout(conn, layout);
+	}
 
 
-		for (auto win: windows) {
-			fluke::Rect new_rect;
 
-			// Master window.
-			if (win == fluke::get_focused_window(conn)) {
-				// Rectangle for master window.
-				new_rect = fluke::get_adjusted_window_rect( std::array{
-					fluke::Rect{ display_x, display_y, master_w, display_h },  // Left
-					fluke::Rect{ display_x + slave_w, display_y, master_w, display_h },  // Right
-				}.at(std::make_unsigned_t<int>(master_side)) );
-			}
+	inline void action_layout_monocle(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_MONOCLE"), "'")
 
-			// Slave windows.
-			else {
-				// Rectangle for slave windows, opposite to `master_side`.
-				new_rect = fluke::get_adjusted_window_rect( std::array{
-					fluke::Rect{ display_x + master_w, std::ceil(sliding_y), slave_w, slave_h },  // Right
-					fluke::Rect{ display_x, std::ceil(sliding_y), slave_w, slave_h },  // Left
-				}.at(std::make_unsigned_t<int>(master_side)) );
+		// Get all of the mapped windows.
+		const auto display_rect = fluke::get_hovered_display_rect(conn);
+		auto windows = fluke::get_mapped_windows_on_display(conn, display_rect);
 
-				// Increment Y position for next window.
-				sliding_y += slave_h;
-			}
+		if (windows.size() == 0)
+			return;
+
+		// Resize all windows on this display.
+		std::vector<fluke::Placement> layout;
+		layout.reserve(windows.size());
 
+		for (auto win: windows)
+			layout.emplace_back(fluke::Placement{ win, fluke::Rect{} });
 
-			// Resize and move current window.
-			const auto [x, y, w, h] = new_rect;
-			fluke::configure_window(conn, win, fluke::XCB_MOVE_RESIZE, x, y, w, h);
-		}
+		fluke::layout_monocle(layout, fluke::get_adjusted_display_rect(display_rect));
+		fluke::apply_layout(conn, layout);
 	}
 
 
 
-	inline void action_layout_monocle(fluke::Connection& conn) {
-		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_MONOCLE"), "'")
+	inline void action_layout_stacked(fluke::Connection& conn, int stack_dir) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("LAYOUT_STACKED"),
+			"' with arg(s) '", tinge::fg::make_yellow(stacked_str[stack_dir]), "'"
+		)
 
-		// Get all of the mapped windows.
-		auto windows = fluke::get_mapped_windows_on_hovered_display(conn);
+		const auto display_rect = fluke::get_hovered_display_rect(conn);
+		auto windows = fluke::get_mapped_windows_on_display(conn, display_rect);
 
-		if (windows.size() == 0)
+		if (windows.size() <= 1)
+			return;
+
+		// Resize all windows on this display.
+		std::vector<fluke::Placement> layout;
+		layout.reserve(windows.size());
+
+		for (auto win: windows)
+			layout.emplace_back(fluke::Placement{ win, fluke::Rect{} });
+
+		fluke::layout_stacked(layout, fluke::get_adjusted_display_rect(display_rect), stack_dir);
+		fluke::apply_layout(conn, layout);
+	}
+
+
+
+
+
+	inline void action_fullscreen(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_MONOCLE"), "'")
+
+		// Get focused window ID.
+		const xcb_window_t focused = fluke::get_focused_window(conn);
+		if (not fluke::is_valid_window(conn, focused))
 			return;
 
 		// Get the geometry for a fullscreen window on the current display.
@@ -511,95 +633,193 @@ namespace fluke {
 				fluke::get_adjusted_display_rect(fluke::get_hovered_display_rect(conn))
 			);
 
-		// Resize all windows on this display.
+		fluke::configure_window(conn, focused, fluke::XCB_MOVE_RESIZE, x, y, w, h);
+	}
+
+
+	inline void action_layout_grid(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_GRID"), "'")
+
+		const auto display_rect = fluke::get_hovered_display_rect(conn);
+		const auto windows = fluke::get_mapped_windows_on_display(conn, display_rect);
+
+		if (windows.size() <= 1)
+			return;
+
+		// Lay windows out left to right, top to bottom in stacking order.
+		std::vector<fluke::Placement> layout;
+		layout.reserve(windows.size());
+
 		for (auto win: windows)
-			fluke::configure_window(conn, win, fluke::XCB_MOVE_RESIZE, x, y, w, h);
+			layout.emplace_back(fluke::Placement{ win, fluke::Rect{} });
+
+		fluke::layout_grid(layout, fluke::get_adjusted_display_rect(display_rect));
+		fluke::apply_layout(conn, layout);
 	}
 
 
 
-	enum {
-		STACK_VERTICAL,
-		STACK_HORIZONTAL,
-	};
+	namespace detail {
+		/*
+			Run a layout function over every connected display at once. The
+			windows are split up by display in one sweep over the window cache
+			and the configures for every display are sent together so they go
+			out in a single flush. `func` is called with the placements of one
+			display and its usable area.
+		*/
+		template <typename F>
+		inline void layout_all_displays(fluke::Connection& conn, const size_t min_windows, F&& func) {
+			const auto& displays = fluke::get_displays(conn);
+			const auto per_display = fluke::get_mapped_windows_by_display(conn);
 
-	constexpr const char* stacked_str[] = {
-		"STACK_VERTICAL",
-		"STACK_HORIZONTAL",
-	};
+			std::vector<fluke::Placement> layout;
+			std::vector<fluke::Placement> display_layout;
 
-	inline void action_layout_stacked(fluke::Connection& conn, int stack_dir) {
+			layout.reserve(conn.windows().size());
+
+			for (size_t i = 0; i < displays.size(); ++i) {
+				const auto& windows = per_display[i];
+
+				if (windows.size() < min_windows)
+					continue;
+
+				display_layout.clear();
+
+				for (auto win: windows)
+					display_layout.emplace_back(fluke::Placement{ win, fluke::Rect{} });
+
+				func(display_layout, fluke::get_adjusted_display_rect(displays[i].rect));
+				layout.insert(layout.end(), display_layout.begin(), display_layout.end());
+			}
+
+			fluke::apply_layout(conn, layout);
+		}
+	}
+
+
+
+	inline void action_layout_masterslave_all(fluke::Connection& conn, int master_side, int master_size) {
 		FLUKE_DEBUG_NOTICE(
-			"action '", tinge::fg::make_yellow("LAYOUT_STACKED"),
-			"' with arg(s) '", tinge::fg::make_yellow(stacked_str[stack_dir]), "'"
+			"action '", tinge::fg::make_yellow("LAYOUT_MASTERSLAVE_ALL"),
+			"' with arg(s) '", tinge::fg::make_yellow(master_str[master_side]), "'"
 		)
 
-		auto windows = fluke::get_mapped_windows_on_hovered_display(conn);
-
-		if (windows.size() <= 1)
-			return;
+		// The focused window is the master of its display, the topmost
+		// window is the master everywhere else.
+		const xcb_window_t focused = fluke::get_focused_window(conn);
 
+		detail::layout_all_displays(conn, 2, [&] (auto& layout, const auto& area) {
+			const bool has_focused = std::any_of(layout.begin(), layout.end(), [focused] (const auto& p) {
+				return p.win == focused;
+			});
 
+			fluke::layout_masterslave(layout, area, has_focused ? focused : layout.front().win, master_side, master_size);
+		});
+	}
 
-		const auto [display_x, display_y, display_w, display_h] =
-			fluke::get_adjusted_display_rect(fluke::get_hovered_display_rect(conn));
 
 
+	inline void action_layout_monocle_all(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_MONOCLE_ALL"), "'")
 
+		detail::layout_all_displays(conn, 1, [] (auto& layout, const auto& area) {
+			fluke::layout_monocle(layout, area);
+		});
+	}
 
-		float winsize = 0;
-		float sliding = 0;
 
 
-		if (stack_dir == STACK_VERTICAL) {
-			sliding = display_y;
-			winsize = float(display_h) / (windows.size());
-		}
+	inline void action_layout_stacked_all(fluke::Connection& conn, int stack_dir) {
+		FLUKE_DEBUG_NOTICE(
+			"action '", tinge::fg::make_yellow("LAYOUT_STACKED_ALL"),
+			"' with arg(s) '", tinge::fg::make_yellow(stacked_str[stack_dir]), "'"
+		)
 
-		else if (stack_dir == STACK_HORIZONTAL) {
-			sliding = display_x;
-			winsize = float(display_w) / (windows.size());
-		}
+		detail::layout_all_displays(conn, 2, [stack_dir] (auto& layout, const auto& area) {
+			fluke::layout_stacked(layout, area, stack_dir);
+		});
+	}
 
 
 
+	inline void action_layout_grid_all(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_GRID_ALL"), "'")
 
-		// Resize all windows on this display.
-		for (auto win: windows) {
-			const auto [x, y, w, h] = fluke::get_adjusted_window_rect( std::array{
-				fluke::Rect{ display_x, sliding, display_w, winsize },  // Vertical
-				fluke::Rect{ sliding, display_y, winsize, display_h },  // Horizontal
-			}.at(std::make_unsigned_t<int>(stack_dir)) );
-
-			fluke::configure_window(conn, win, fluke::XCB_MOVE_RESIZE, x, y, w, h);
-			sliding += winsize;
-		}
+		detail::layout_all_displays(conn, 2, [] (auto& layout, const auto& area) {
+			fluke::layout_grid(layout, area);
+		});
 	}
 
 
 
+	/*
+		Toggle BSP tiling on the hovered display. When turned on, the mapped
+		windows are inserted in stacking order and from then on windows are
+		tiled as they are mapped and unmapped. Turning it off leaves windows
+		where they are.
+	*/
+	inline void action_layout_bsp(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_BSP"), "'")
 
+		const auto [crtc, rect, refresh] = fluke::get_hovered_display(conn);
 
-	inline void action_fullscreen(fluke::Connection& conn) {
-		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("LAYOUT_MONOCLE"), "'")
+		if (crtc == XCB_NONE)
+			return;
 
-		// Get focused window ID.
-		const xcb_window_t focused = fluke::get_focused_window(conn);
-		if (not fluke::is_valid_window(conn, focused))
+		if (conn.tiling().erase(crtc))
 			return;
 
-		// Get the geometry for a fullscreen window on the current display.
-		const auto [x, y, w, h] =
-			fluke::get_adjusted_window_rect(
-				fluke::get_adjusted_display_rect(fluke::get_hovered_display_rect(conn))
-			);
+		auto& tree = conn.tiling()[crtc];
+		const auto area = fluke::get_adjusted_display_rect(rect);
 
-		fluke::configure_window(conn, focused, fluke::XCB_MOVE_RESIZE, x, y, w, h);
+		tree.reset(area);
+
+		std::vector<fluke::Placement> layout;
+
+		for (auto win: fluke::get_mapped_windows_on_display(conn, rect))
+			tree.insert(win, XCB_NONE, layout);
+
+		// Windows near the root are moved by every insertion, lay the
+		// finished tree out once instead.
+		layout.clear();
+		tree.resize(area, layout);
+
+		fluke::apply_bsp_layout(conn, layout);
+	}
+
+
+
+	/*
+		Grow or shrink the focused window by moving the split it shares with
+		its sibling, only the windows on either side of that split are moved.
+	*/
+	inline void action_bsp_ratio(fluke::Connection& conn, float delta) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("BSP_RATIO"), "'")
+
+		const xcb_window_t focused = fluke::get_focused_window(conn);
+
+		for (auto& [crtc, tree]: conn.tiling()) {
+			if (not tree.contains(focused))
+				continue;
+
+			std::vector<fluke::Placement> changed;
+			tree.adjust_ratio(focused, delta, changed);
+
+			fluke::apply_bsp_layout(conn, changed);
+			return;
+		}
 	}
 
 
-	inline void action_layout_grid(fluke::Connection&) {
 
+	/*
+		Restart fluke in place, for example after rebuilding it with a new
+		config. The restart happens once the current batch of events has
+		been handled, see `fluke::restart`.
+	*/
+	inline void action_restart(fluke::Connection& conn) {
+		FLUKE_DEBUG_NOTICE("action '", tinge::fg::make_yellow("RESTART"), "'")
+		conn.request_restart();
 	}
 }
 
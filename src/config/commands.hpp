@@ -0,0 +1,78 @@
+#ifndef FLUKE_CONFIG_COMMANDS_HPP
+#define FLUKE_CONFIG_COMMANDS_HPP
+
+#pragma once
+
+#include <iterator>
+#include <cstdint>
+
+
+// Macros to wrap actions as commands for the control socket. Arguments are
+// integers in `args`, the number of them is checked before the command is
+// run. Requests made by the command are attributed to it by the profiler.
+#define COMMAND(name, argc, ...) fluke::Command{ name, argc, [] (fluke::Connection& conn, [[maybe_unused]] const int32_t* args) { \
+	fluke::ProfileScope scope{"ipc(" name ")"}; \
+	__VA_ARGS__; \
+	return true; \
+} }
+
+// Reject an argument which isn't one of the values of an enum, `strings`
+// is the array of names which goes with the enum.
+#define CHECK_ENUM(i, strings) \
+	if (args[i] < 0 or static_cast<size_t>(args[i]) >= std::size(strings)) return false
+
+#define CHECK_RANGE(i, min, max) \
+	if (args[i] < (min) or args[i] > (max)) return false
+
+
+// Commands which can be run with `flukec <name> [args...]`.
+namespace fluke::config {
+	constexpr fluke::Commands commands {
+		COMMAND("resize", 4, fluke::action_resize(conn, args[0], args[1], args[2], args[3])),
+		COMMAND("center", 0, fluke::action_center(conn)),
+		COMMAND("center_resize", 0, fluke::action_center_resize(conn)),
+		COMMAND("fullscreen", 0, fluke::action_fullscreen(conn)),
+
+		// Focus.
+		COMMAND("focus", 1, CHECK_ENUM(0, fluke::focus_str); fluke::action_focus(conn, args[0])),
+		COMMAND("focus_dir", 1, CHECK_ENUM(0, fluke::focus_dir_str); fluke::action_focus_dir(conn, args[0])),
+		COMMAND("focus_display_index", 1, fluke::action_focus_display_index(conn, args[0])),
+
+		COMMAND("snap", 1, CHECK_ENUM(0, fluke::side_str); fluke::action_snap(conn, args[0])),
+
+		// Workspaces, indices which are out of range are ignored by the actions.
+		COMMAND("workspace_change", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_workspace_change(conn, static_cast<size_t>(args[0]))),
+		COMMAND("workspace_send_to", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_workspace_send_to(conn, static_cast<size_t>(args[0]))),
+
+		// Scratchpads.
+		COMMAND("scratchpad_show", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_scratchpad_show(conn, static_cast<size_t>(args[0]))),
+		COMMAND("scratchpad_hide", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_scratchpad_hide(conn, static_cast<size_t>(args[0]))),
+		COMMAND("scratchpad_toggle", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_scratchpad_toggle(conn, static_cast<size_t>(args[0]))),
+		COMMAND("scratchpad_add", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_scratchpad_add(conn, static_cast<size_t>(args[0]))),
+		COMMAND("scratchpad_remove", 1, CHECK_RANGE(0, 0, INT32_MAX); fluke::action_scratchpad_remove(conn, static_cast<size_t>(args[0]))),
+
+		// Layouts, the master size is a percentage.
+		COMMAND("layout_masterslave", 2, CHECK_ENUM(0, fluke::master_str); CHECK_RANGE(1, 1, 99); fluke::action_layout_masterslave(conn, args[0], args[1])),
+		COMMAND("layout_monocle", 0, fluke::action_layout_monocle(conn)),
+		COMMAND("layout_stacked", 1, CHECK_ENUM(0, fluke::stacked_str); fluke::action_layout_stacked(conn, args[0])),
+		COMMAND("layout_grid", 0, fluke::action_layout_grid(conn)),
+
+		COMMAND("layout_masterslave_all", 2, CHECK_ENUM(0, fluke::master_str); CHECK_RANGE(1, 1, 99); fluke::action_layout_masterslave_all(conn, args[0], args[1])),
+		COMMAND("layout_monocle_all", 0, fluke::action_layout_monocle_all(conn)),
+		COMMAND("layout_stacked_all", 1, CHECK_ENUM(0, fluke::stacked_str); fluke::action_layout_stacked_all(conn, args[0])),
+		COMMAND("layout_grid_all", 0, fluke::action_layout_grid_all(conn)),
+
+		// BSP tiling, the ratio is changed by hundredths.
+		COMMAND("layout_bsp", 0, fluke::action_layout_bsp(conn)),
+		COMMAND("bsp_ratio", 1, CHECK_RANGE(0, -100, 100); fluke::action_bsp_ratio(conn, static_cast<float>(args[0]) / 100.0f)),
+
+		COMMAND("restart", 0, fluke::action_restart(conn)),
+	};
+}
+
+
+#undef COMMAND
+#undef CHECK_ENUM
+#undef CHECK_RANGE
+
+#endif
@@ -7,7 +7,7 @@
 // User hooks
 namespace fluke {
 	// Hooks called on launch and exit.
-	inline void on_launch(fluke::Connection&) {
+	inline void on_launch(fluke::Connection& conn) {
 		fluke::exec("xsetroot", "-cursor_name", "left_ptr");
 		fluke::exec("keyboard_set");
 		fluke::exec("run_once","picom");
@@ -15,6 +15,9 @@ namespace fluke {
 		fluke::exec("run_once","dunst");
 		fluke::exec("autorandr", "-c");
 		fluke::exec("wallpaper_random");
+
+		// Start scratchpads hidden so they show up instantly when toggled.
+		fluke::launch_scratchpads(conn);
 	}
 
 	inline void on_exit(fluke::Connection&) {}
@@ -40,18 +43,35 @@ namespace fluke {
 	inline void on_unmap(fluke::Connection&, const fluke::UnmapNotifyEvent&) {}
 
 
-	// This is called when a window asks to be configured.
+	// This is called when a window asks to be configured and
+	// after a window has been configured.
 	inline void on_configure(fluke::Connection&, const fluke::ConfigureRequestEvent&) {}
+	inline void on_configure_notify(fluke::Connection&, const fluke::ConfigureNotifyEvent&) {}
 
 
 	// This is called when the pointer is moved.
 	inline void on_motion(fluke::Connection&, const fluke::MotionNotifyEvent&) {}
 
 
+	// This is called with the newest pointer position, at most once per
+	// batch. With `MOTION_HINTS` on it is also called when the reply to a
+	// pointer query has a newer position, which is at most once per refresh.
+	inline void on_pointer(fluke::Connection&, const fluke::Point&) {}
+
+
+	// These are called when a grabbed button is pressed or released.
+	inline void on_button_press(fluke::Connection&, const fluke::ButtonPressEvent&) {}
+	inline void on_button_release(fluke::Connection&, const fluke::ButtonReleaseEvent&) {}
+
+
 	// This is called when a grabbed key is pressed.
 	inline void on_keypress(fluke::Connection&, const fluke::KeyPressEvent&) {}
 
 
+	// This is called when the keyboard or modifier mapping changes.
+	inline void on_mapping(fluke::Connection&, const fluke::MappingNotifyEvent&) {}
+
+
 	// Called when an error occurs.
 	inline void on_error(fluke::Connection&, const fluke::Error&) {}
 
@@ -5,8 +5,16 @@
 
 
 // Macros to partially apply callback functions with variadic arguments.
-#define ACTION(func, ...) [] (auto& conn) { func(conn, ##__VA_ARGS__); }
-#define RUN(...) [] (auto&) { fluke::exec(__VA_ARGS__); }
+// Requests made by the callback are attributed to the keybinding by the profiler.
+#define ACTION(func, ...) [] (auto& conn) { \
+	fluke::ProfileScope scope{#func "(" #__VA_ARGS__ ")"}; \
+	func(conn, ##__VA_ARGS__); \
+}
+
+#define RUN(...) [] (auto&) { \
+	fluke::ProfileScope scope{"fluke::exec(" #__VA_ARGS__ ")"}; \
+	fluke::exec(__VA_ARGS__); \
+}
 
 
 // Keybindings
@@ -69,15 +77,52 @@ namespace fluke::config {
 		fluke::Key{ keys::super | keys::alt, keys::number_8, ACTION(fluke::action_focus_display_index, 7) },
 		fluke::Key{ keys::super | keys::alt, keys::number_9, ACTION(fluke::action_focus_display_index, 8) },
 
+		// Workspaces.
+		fluke::Key{ keys::super, keys::number_1, ACTION(fluke::action_workspace_change, 0) },
+		fluke::Key{ keys::super, keys::number_2, ACTION(fluke::action_workspace_change, 1) },
+		fluke::Key{ keys::super, keys::number_3, ACTION(fluke::action_workspace_change, 2) },
+		fluke::Key{ keys::super, keys::number_4, ACTION(fluke::action_workspace_change, 3) },
+		fluke::Key{ keys::super, keys::number_5, ACTION(fluke::action_workspace_change, 4) },
+		fluke::Key{ keys::super, keys::number_6, ACTION(fluke::action_workspace_change, 5) },
+		fluke::Key{ keys::super, keys::number_7, ACTION(fluke::action_workspace_change, 6) },
+		fluke::Key{ keys::super, keys::number_8, ACTION(fluke::action_workspace_change, 7) },
+		fluke::Key{ keys::super, keys::number_9, ACTION(fluke::action_workspace_change, 8) },
+
+		fluke::Key{ keys::super | keys::shift, keys::number_1, ACTION(fluke::action_workspace_send_to, 0) },
+		fluke::Key{ keys::super | keys::shift, keys::number_2, ACTION(fluke::action_workspace_send_to, 1) },
+		fluke::Key{ keys::super | keys::shift, keys::number_3, ACTION(fluke::action_workspace_send_to, 2) },
+		fluke::Key{ keys::super | keys::shift, keys::number_4, ACTION(fluke::action_workspace_send_to, 3) },
+		fluke::Key{ keys::super | keys::shift, keys::number_5, ACTION(fluke::action_workspace_send_to, 4) },
+		fluke::Key{ keys::super | keys::shift, keys::number_6, ACTION(fluke::action_workspace_send_to, 5) },
+		fluke::Key{ keys::super | keys::shift, keys::number_7, ACTION(fluke::action_workspace_send_to, 6) },
+		fluke::Key{ keys::super | keys::shift, keys::number_8, ACTION(fluke::action_workspace_send_to, 7) },
+		fluke::Key{ keys::super | keys::shift, keys::number_9, ACTION(fluke::action_workspace_send_to, 8) },
+
 		// Layouts.
 		fluke::Key{ keys::super, keys::t, ACTION(fluke::action_layout_masterslave, MASTER_LEFT, 60) },
 		fluke::Key{ keys::super, keys::m, ACTION(fluke::action_layout_monocle) },
+		fluke::Key{ keys::super, keys::g, ACTION(fluke::action_layout_grid) },
+		fluke::Key{ keys::super, keys::b, ACTION(fluke::action_layout_bsp) },
+		fluke::Key{ keys::super, keys::bracketleft,  ACTION(fluke::action_bsp_ratio, -0.05f) },
+		fluke::Key{ keys::super, keys::bracketright, ACTION(fluke::action_bsp_ratio, +0.05f) },
 		fluke::Key{ keys::super, keys::s, ACTION(fluke::action_layout_stacked, STACK_VERTICAL) },
 		fluke::Key{ keys::super | keys::shift, keys::s, ACTION(fluke::action_layout_stacked, STACK_HORIZONTAL) },
 
+		// Layouts on every display at once.
+		fluke::Key{ keys::super | keys::control, keys::t, ACTION(fluke::action_layout_masterslave_all, MASTER_LEFT, 60) },
+		fluke::Key{ keys::super | keys::control, keys::m, ACTION(fluke::action_layout_monocle_all) },
+		fluke::Key{ keys::super | keys::control, keys::g, ACTION(fluke::action_layout_grid_all) },
+		fluke::Key{ keys::super | keys::control, keys::s, ACTION(fluke::action_layout_stacked_all, STACK_VERTICAL) },
+		fluke::Key{ keys::super | keys::control | keys::shift, keys::s, ACTION(fluke::action_layout_stacked_all, STACK_HORIZONTAL) },
+
+		// Scratchpads.
+		fluke::Key{ keys::super, keys::semicolon, ACTION(fluke::action_scratchpad_toggle, 0) },
+		fluke::Key{ keys::super | keys::shift, keys::semicolon, ACTION(fluke::action_scratchpad_toggle, 1) },
+
 		// Misc.
 		fluke::Key{ keys::super, keys::f, ACTION(fluke::action_fullscreen) },
 		fluke::Key{ keys::super, keys::c, ACTION(fluke::action_center_resize) },
+		fluke::Key{ keys::super | keys::shift, keys::r, ACTION(fluke::action_restart) },
 
 		// Launch programs.
 		fluke::Key{ keys::super, keys::ret, RUN("st") },
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 
 namespace fluke::config {
 	// argb format
@@ -29,6 +31,49 @@ namespace fluke::config {
 	constexpr auto GUTTER_BOTTOM = 1;
 
 	constexpr auto GAP = 1;
+
+
+	// Hold DRAG_MODIFIER and drag a window with DRAG_MOVE_BUTTON to move it
+	// or with DRAG_RESIZE_BUTTON to resize it. Dragged windows snap to the
+	// edges of the display under the pointer when they come within
+	// SNAP_DISTANCE pixels of them.
+	constexpr unsigned DRAG_MODIFIER      = 1u << 6;  // super (XCB_MOD_MASK_4)
+	constexpr unsigned DRAG_MOVE_BUTTON   = 1;        // left
+	constexpr unsigned DRAG_RESIZE_BUTTON = 3;        // right
+
+	constexpr auto SNAP_DISTANCE = 16;
+	constexpr auto DRAG_MIN_SIZE = 32;
+
+
+	// Ask for pointer motion as hints, X then sends one MotionNotify and
+	// waits for us to query the pointer before it sends another. We query
+	// at most once per refresh of the display under the pointer so high
+	// polling rate mice don't wake us up a thousand times a second while
+	// dragging. Positions may be up to a frame old.
+	constexpr auto MOTION_HINTS = false;
+
+
+	// Number of workspaces on every display.
+	constexpr size_t WORKSPACE_COUNT = 9;
+
+
+	// Forward at most one move/resize per window for every refresh of
+	// its display, newer geometry is held back until the next refresh.
+	// Saves a lot of work for X and the compositor when dragging with
+	// programs like `xmmv` at the cost of geometry lagging by up to a
+	// frame, off by default.
+	constexpr auto PACE_CONFIGURE_REQUESTS = false;
+
+
+	// Save what we know about every window to a snapshot on exit, the
+	// next instance on the same display picks it up instead of asking X
+	// about every window, restoring workspaces, scratchpads and tiling.
+	constexpr auto SNAPSHOT_ON_EXIT = true;
+
+
+	// Count requests and time how long we block on replies, the results
+	// are printed when fluke receives SIGUSR1 and on exit.
+	constexpr auto PROFILE_REQUESTS = true;
 }
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef FLUKE_CONFIG_SCRATCHPADS_HPP
+#define FLUKE_CONFIG_SCRATCHPADS_HPP
+
+#pragma once
+
+
+// Scratchpads
+// These programs are started hidden by `fluke::launch_scratchpads` in the
+// `on_launch` hook and toggled with `action_scratchpad_toggle`.
+namespace fluke::config {
+	constexpr std::array scratchpads {
+		fluke::ScratchpadConfig{ "scratchpad_term", { "st", "-n", "scratchpad_term" }, 60, 50 },
+		fluke::ScratchpadConfig{ "scratchpad_calc", { "st", "-n", "scratchpad_calc", "-e", "bc", "-l" }, 30, 40 },
+	};
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef FLUKE_DISPATCH_HPP
+#define FLUKE_DISPATCH_HPP
+
+#pragma once
+
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Cast a generic event to its concrete type and call the matching
+		`event_*` handler.
+
+		`randr_base` is the first event code of the randr extension which
+		we need in order to tell randr events apart.
+
+		example:
+			fluke::handle_event(conn, randr_base, fluke::get_next_event(conn));
+	*/
+	inline void handle_event(fluke::Connection& conn, const int randr_base, fluke::Event&& event) {
+		const auto ev_type = fluke::get_event_type(event);
+		const auto randr_ev_type = ev_type - randr_base;
+
+		// Attribute requests made by the handler to the event.
+		fluke::ProfileScope scope{
+			(randr_ev_type == XCB_RANDR_SCREEN_CHANGE_NOTIFY or randr_ev_type == XCB_RANDR_NOTIFY) ?
+				fluke::randr_event_str[randr_ev_type] : fluke::event_str[ev_type]
+		};
+
+		// Handle all events.
+		switch (ev_type) {
+			case XCB_MOTION_NOTIFY:
+				fluke::event_motion_notify(conn,
+					fluke::event_cast<fluke::MotionNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_BUTTON_PRESS:
+				fluke::event_button_press(conn,
+					fluke::event_cast<fluke::ButtonPressEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_BUTTON_RELEASE:
+				fluke::event_button_release(conn,
+					fluke::event_cast<fluke::ButtonReleaseEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_CONFIGURE_REQUEST:
+				fluke::event_configure_request(conn,
+					fluke::event_cast<fluke::ConfigureRequestEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_KEY_PRESS:
+				fluke::event_keypress(conn,
+					fluke::event_cast<fluke::KeyPressEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_MAPPING_NOTIFY:
+				fluke::event_mapping_notify(conn,
+					fluke::event_cast<fluke::MappingNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case 0:
+				fluke::event_error(conn,
+					fluke::event_cast<fluke::Error>(std::move(event))
+				);
+				return;
+
+			case XCB_ENTER_NOTIFY:
+				fluke::event_enter_notify(conn,
+					fluke::event_cast<fluke::EnterNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_LEAVE_NOTIFY:
+				fluke::event_leave_notify(conn,
+					fluke::event_cast<fluke::LeaveNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_FOCUS_IN:
+				fluke::event_focus_in(conn,
+					fluke::event_cast<fluke::FocusInEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_FOCUS_OUT:
+				fluke::event_focus_out(conn,
+					fluke::event_cast<fluke::FocusOutEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_CREATE_NOTIFY:
+				fluke::event_create_notify(conn,
+					fluke::event_cast<fluke::CreateNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_DESTROY_NOTIFY:
+				fluke::event_destroy_notify(conn,
+					fluke::event_cast<fluke::DestroyNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_MAP_REQUEST:
+				fluke::event_map_request(conn,
+					fluke::event_cast<fluke::MapRequestEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_UNMAP_NOTIFY:
+				fluke::event_unmap_notify(conn,
+					fluke::event_cast<fluke::UnmapNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_CONFIGURE_NOTIFY:
+				fluke::event_configure_notify(conn,
+					fluke::event_cast<fluke::ConfigureNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_REPARENT_NOTIFY:
+				fluke::event_reparent_notify(conn,
+					fluke::event_cast<fluke::ReparentNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_PROPERTY_NOTIFY:
+				fluke::event_property_notify(conn,
+					fluke::event_cast<fluke::PropertyNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_CLIENT_MESSAGE:
+				fluke::event_client_message(conn,
+					fluke::event_cast<fluke::ClientMessageEvent>(std::move(event))
+				);
+				return;
+		}
+
+
+		// Handle randr events, these checks are exhaustive so we
+		// do not need to check for unhandled randr events.
+		switch (randr_ev_type) {
+			case XCB_RANDR_SCREEN_CHANGE_NOTIFY:
+				fluke::event_randr_screen_change_notify(conn,
+					fluke::event_cast<fluke::RandrScreenChangeNotifyEvent>(std::move(event))
+				);
+				return;
+
+			case XCB_RANDR_NOTIFY:
+				fluke::event_randr_notify(conn,
+					fluke::event_cast<fluke::RandrNotifyEvent>(std::move(event))
+				);
+				return;
+		}
+
+
+		// Warn about unhandled events.
+		FLUKE_DEBUG_WARN("unhandled event '", fluke::event_str[ev_type], "'!")
+	}
+}
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef FLUKE_EVENT_BATCH_HPP
+#define FLUKE_EVENT_BATCH_HPP
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fluke.hpp>
+
+namespace fluke {
+	/*
+		Collects every event which is already queued and folds away events
+		which would be made redundant by a newer event of the same kind.
+
+		- Consecutive ConfigureRequests for the same window are merged into a
+		  single request with the union of their value masks, newer values win.
+
+		- Only the newest MotionNotify is kept. With motion hints on, X
+		  is asked for the next one once the batch has been handled.
+
+		This matters for programs like `xmmv` from wmutils which can flood
+		us with ConfigureRequests faster than we can forward them.
+
+		Requests made by the handlers are only flushed once there are no
+		more events to read, right before we block, so a burst of events
+		costs a single write to the X socket.
+
+		Blocking is done by `fluke::EventLoop` which also wakes up for
+		signals and timers. While ConfigureRequests are being paced (see
+		`fluke::ConfigurePacer`) a timer wakes us up when the next one is
+		due so the final geometry of a drag always lands.
+
+		example:
+			fluke::EventBatch batch;
+
+			while (batch.fill(conn))
+				batch.dispatch(conn, randr_base);
+	*/
+	class EventBatch {
+		// Data
+		private:
+			std::vector<fluke::Event> events;
+
+			// Index of the newest MotionNotify in `events`.
+			size_t last_motion = npos;
+
+			static constexpr size_t npos = static_cast<size_t>(-1);
+
+
+		// Helpers
+		private:
+			static auto as_configure_request(const fluke::Event& e) {
+				return reinterpret_cast<xcb_configure_request_event_t*>(e.get());
+			}
+
+
+			// Query the pointer if a motion hint is waiting to be re-armed
+			// and the refresh interval of the display under the pointer is
+			// over. The reply is collected by `collect_motion`.
+			static void rearm_motion(fluke::Connection& conn) {
+				auto& motion = conn.motion();
+				const auto now = fluke::MotionTracker::clock::now();
+
+				if (not motion.due(now) or conn.trace().replaying())
+					return;
+
+				const auto& p = motion.position();
+				const auto refresh = fluke::get_nearest_display(conn, fluke::Rect{ p.x, p.y, 0, 0 }).refresh;
+
+				const auto cookie = fluke::query_pointer(conn, conn.root());
+				motion.queried(cookie.cookie.sequence, now, std::chrono::nanoseconds{refresh});
+
+				conn.stats().motion_queries++;
+			}
+
+
+			// Pick up the reply to a motion hint query if it has arrived, never
+			// blocks. When replaying, the replies which were handled at this
+			// point of the recording are taken from the trace instead.
+			static void collect_motion(fluke::Connection& conn) {
+				auto& motion = conn.motion();
+				auto& trace = conn.trace();
+
+				if (trace.replaying()) {
+					while (const auto pointer = fluke::QueryPointerReply{trace.next_motion(), &std::free}) {
+						if (motion.moved(fluke::as_point(pointer)))
+							fluke::handle_pointer_motion(conn, motion.position());
+					}
+
+					return;
+				}
+
+				if (not motion.awaiting())
+					return;
+
+				void* reply = nullptr;
+				xcb_generic_error_t* error = nullptr;
+
+				if (xcb_poll_for_reply(conn, motion.sequence(), &reply, &error) == 0)
+					return;
+
+				motion.answered();
+				std::free(error);
+
+				const auto pointer = fluke::QueryPointerReply{static_cast<xcb_query_pointer_reply_t*>(reply), &std::free};
+
+				// A missing reply isn't recorded, there is nothing to replay.
+				if (pointer)
+					trace.write(fluke::Trace::Kind::motion, pointer.get(), sizeof(xcb_query_pointer_reply_t));
+
+				if (pointer and motion.moved(fluke::as_point(pointer)))
+					fluke::handle_pointer_motion(conn, motion.position());
+			}
+
+
+			// Flush our requests and block until an event arrives. If there
+			// are paced ConfigureRequests waiting, the pacer timer wakes us
+			// up when the next one is due so we can forward it. Signals and
+			// other watched files wake us up too, in which case we go back to
+			// waiting unless the event loop has been stopped.
+			static fluke::Event wait(fluke::Connection& conn) {
+				auto& pacer = conn.pacer();
+				auto& loop = conn.loop();
+
+				while (true) {
+					fluke::forward_due_configure_requests(conn);
+					rearm_motion(conn);
+
+					conn.flush();
+					conn.stats().flushes++;
+
+					if (not loop.is_open())
+						return fluke::get_next_event(conn);
+
+					// Events may have been read while we were waiting on a reply.
+					if (auto event = fluke::Event{xcb_poll_for_queued_event(conn), &std::free})
+						return event;
+
+					// The timer is shared with motion hints which are waiting
+					// for their refresh interval to be over.
+					auto deadline = fluke::ConfigurePacer::clock::time_point::max();
+
+					if (pacer.pending())
+						deadline = pacer.deadline();
+
+					if (conn.motion().pending())
+						deadline = std::min(deadline, conn.motion().deadline());
+
+					if (deadline != fluke::ConfigurePacer::clock::time_point::max())
+						loop.pacer().arm(deadline);
+
+					else
+						loop.pacer().disarm();
+
+					const bool x_ready = loop.wait([&conn] (int fd) {
+						fluke::handle_ipc(conn, fd);
+					});
+
+					// A command from the control socket may have stopped us or
+					// asked for a restart, the main loop has to see it.
+					if (loop.stopped() or conn.restart_requested())
+						return fluke::Event{nullptr, &std::free};
+
+					if (not x_ready)
+						continue;
+
+					if (auto event = fluke::Event{xcb_poll_for_event(conn), &std::free})
+						return event;
+
+					// Only a reply arrived, the pointer may have stopped moving.
+					collect_motion(conn);
+
+					if (xcb_connection_has_error(conn) != 0)
+						return fluke::Event{nullptr, &std::free};
+				}
+			}
+
+
+			// Add an event to the batch, folding it into an older event if possible.
+			void push(fluke::Connection& conn, fluke::Event&& event) {
+				auto& stats = conn.stats();
+				stats.events_received++;
+
+				conn.trace().write(fluke::Trace::Kind::event, event.get(), sizeof(xcb_generic_event_t));
+
+				const auto ev_type = fluke::get_event_type(event);
+
+				if (ev_type == XCB_CONFIGURE_REQUEST and not events.empty()) {
+					const auto& last = events.back();
+
+					if (
+						last and
+						fluke::get_event_type(last) == XCB_CONFIGURE_REQUEST and
+						as_configure_request(last)->window == as_configure_request(event)->window
+					) {
+						fluke::merge_configure_request(*as_configure_request(last), *as_configure_request(event));
+						stats.configure_requests_folded++;
+						return;
+					}
+				}
+
+				if (ev_type == XCB_MOTION_NOTIFY) {
+					// Drop the older motion event, its slot is skipped on dispatch.
+					if (last_motion != npos) {
+						events[last_motion].reset();
+						stats.motion_notifies_folded++;
+					}
+
+					last_motion = events.size();
+				}
+
+				events.emplace_back(std::move(event));
+			}
+
+
+		// Functions
+		public:
+			/*
+				Take every event which is available without blocking. If there
+				are none, flush our requests and block until an event arrives.
+
+				Returns false if the connection to X has been lost or the
+				event loop has been stopped.
+
+				When replaying a trace, the next recorded batch is taken
+				instead and false is returned at the end of the trace.
+			*/
+			bool fill(fluke::Connection& conn) {
+				events.clear();
+				last_motion = npos;
+
+				if (conn.loop().stopped())
+					return false;
+
+				auto& trace = conn.trace();
+
+				if (trace.replaying()) {
+					// Motion hint replies which arrived between batches.
+					collect_motion(conn);
+
+					if (not trace.next_batch())
+						return false;
+
+					while (auto recorded = fluke::Event{trace.next_event(), &std::free})
+						push(conn, std::move(recorded));
+
+					return true;
+				}
+
+				// A steady stream of events would keep us from ever waiting
+				// so paced requests which are due are forwarded here as well.
+				if (conn.pacer().pending())
+					fluke::forward_due_configure_requests(conn);
+
+				// Read from the socket without blocking first, we only flush
+				// when we have run out of work.
+				auto event = fluke::Event{xcb_poll_for_event(conn), &std::free};
+
+				if (not event)
+					event = wait(conn);
+
+				// Hand back an empty batch so the main loop can restart.
+				if (not event and conn.restart_requested())
+					return true;
+
+				if (xcb_connection_has_error(conn) != 0 or not event)
+					return false;
+
+				trace.batch();
+				push(conn, std::move(event));
+
+				while (auto queued = fluke::Event{xcb_poll_for_queued_event(conn), &std::free})
+					push(conn, std::move(queued));
+
+				return true;
+			}
+
+
+			// Handle every event in the batch in the order it was received.
+			void dispatch(fluke::Connection& conn, const int randr_base) {
+				auto& stats = conn.stats();
+				stats.batches++;
+				stats.largest_batch = std::max(stats.largest_batch, events.size());
+
+				// The reply is older than any motion in this batch.
+				collect_motion(conn);
+
+				for (auto& event: events) {
+					if (not event)
+						continue;
+
+					stats.events_dispatched++;
+					fluke::handle_event(conn, randr_base, std::move(event));
+				}
+
+				events.clear();
+				last_motion = npos;
+
+				// One query per batch at most.
+				rearm_motion(conn);
+			}
+
+
+			auto size() const noexcept {
+				return events.size();
+			}
+	};
+
+
+
+	/*
+		Print the event loop statistics.
+
+		example:
+			fluke::print_event_stats(conn);
+	*/
+	inline void print_event_stats(fluke::Connection& conn) {
+		const auto& stats = conn.stats();
+
+		tinge::noticeln("event loop statistics:");
+		tinge::noticeln(tinge::before{'\t'}, "batches             ", tinge::fg::make_yellow(stats.batches));
+		tinge::noticeln(tinge::before{'\t'}, "largest batch       ", tinge::fg::make_yellow(stats.largest_batch));
+		tinge::noticeln(tinge::before{'\t'}, "flushes             ", tinge::fg::make_yellow(stats.flushes));
+		tinge::noticeln(tinge::before{'\t'}, "events received     ", tinge::fg::make_yellow(stats.events_received));
+		tinge::noticeln(tinge::before{'\t'}, "events dispatched   ", tinge::fg::make_yellow(stats.events_dispatched));
+		tinge::noticeln(tinge::before{'\t'}, "configures folded   ", tinge::fg::make_yellow(stats.configure_requests_folded));
+		tinge::noticeln(tinge::before{'\t'}, "motions folded      ", tinge::fg::make_yellow(stats.motion_notifies_folded));
+		tinge::noticeln(tinge::before{'\t'}, "configures paced    ", tinge::fg::make_yellow(stats.configure_requests_paced));
+		tinge::noticeln(tinge::before{'\t'}, "motion queries      ", tinge::fg::make_yellow(stats.motion_queries));
+		tinge::noticeln(tinge::before{'\t'}, "ipc requests        ", tinge::fg::make_yellow(stats.ipc_requests));
+	}
+}
+
+#endif
@@ -86,6 +86,8 @@ namespace fluke {
 			"' for '", tinge::fg::make_yellow(fluke::to_hex(win)), "'"
 		)
 
+		conn.workspaces().focus(win);
+
 		// Move cursor to center of window.
 		// fluke::center_pointer_in_rect(conn, fluke::as_rect(fluke::get(conn, fluke::get_geometry(conn, win))));
 		fluke::change_window_attributes(conn, win, XCB_CW_BORDER_PIXEL, config::BORDER_COLOUR_ACTIVE);
@@ -130,7 +132,15 @@ namespace fluke {
 	inline void event_create_notify(fluke::Connection& conn, const fluke::CreateNotifyEvent& e) {
 		const xcb_window_t win = e->window;
 
-		if (fluke::is_ignored(fluke::get(conn, fluke::get_window_attributes(conn, win))))
+		// New windows are placed on top of the stack.
+		conn.windows().insert(fluke::Client{
+			win,
+			fluke::Rect{e->x, e->y, e->width, e->height},
+			false,
+			static_cast<bool>(e->override_redirect)
+		});
+
+		if (e->override_redirect)
 			return;
 
 		fluke::on_create(conn, e);
@@ -171,6 +181,23 @@ namespace fluke {
 	inline void event_destroy_notify(fluke::Connection& conn, const fluke::DestroyNotifyEvent& e) {
 		const xcb_window_t win = e->window;
 
+		// We get this event twice for managed windows, once from the root window
+		// and once from the window itself. Ignored windows only report to the root
+		// window so we have to update the cache before filtering.
+		conn.windows().erase(win);
+		conn.pacer().erase(win);
+		conn.workspaces().remove(win);
+		conn.workspaces().take_unmap(win);
+
+		if (const auto i = conn.scratchpads().find(win); i != fluke::Scratchpads::npos)
+			conn.scratchpads().release(i);
+		fluke::untile_window(conn, win);
+
+		if (conn.drag().win == win) {
+			fluke::ungrab_pointer(conn);
+			conn.drag().reset();
+		}
+
 		if (e->event != win)
 			return;
 
@@ -214,11 +241,42 @@ namespace fluke {
 			"' for '", tinge::fg::make_yellow(fluke::to_hex(win)), "'"
 		)
 
+		// Scratchpads stay hidden until they are toggled, a scratchpad
+		// which maps itself is shown.
+		if (const auto i = conn.scratchpads().find(win); i != fluke::Scratchpads::npos) {
+			fluke::show_scratchpad(conn, i);
+			return;
+		}
+
+		if (fluke::claim_scratchpad(conn, win))
+			return;
+
+		auto& workspaces = conn.workspaces();
+
+		// Windows on a workspace which isn't visible are mapped when we
+		// switch to it.
+		if (workspaces.is_hidden(win))
+			return;
+
+		// New windows go on the active workspace of the display they are on.
+		if (not workspaces.contains(win)) {
+			const auto client = conn.windows().find(win);
+
+			workspaces.add(win, client ?
+				fluke::get_nearest_display(conn, client->rect).crtc :
+				fluke::get_hovered_display(conn).crtc
+			);
+		}
+
 		const xcb_window_t focused = fluke::get_focused_window(conn);
 
 
 		fluke::map_window(conn, win);
 
+		conn.windows().set_mapped(win, true);
+
+		fluke::tile_window(conn, win, focused);
+
 		if (fluke::is_valid_window(conn, focused))
 			fluke::configure_window(conn, focused, XCB_CONFIG_WINDOW_STACK_MODE, XCB_STACK_MODE_BELOW);
 
@@ -235,6 +293,20 @@ namespace fluke {
 	inline void event_unmap_notify(fluke::Connection& conn, const fluke::UnmapNotifyEvent& e) {
 		const xcb_window_t win = e->window;
 
+		conn.windows().set_mapped(win, false);
+
+		// We see this event on the root window and on the window itself,
+		// only look at one of them. Unless we hid the window while switching
+		// workspace, the client has withdrawn it so it leaves its workspace
+		// and its BSP tree. Windows we hid were untiled when we hid them.
+		if (e->event == conn.root() and not conn.workspaces().take_unmap(win)) {
+			conn.workspaces().remove(win);
+			fluke::untile_window(conn, win);
+		}
+
+		if (const auto i = conn.scratchpads().find(win); i != fluke::Scratchpads::npos)
+			conn.scratchpads()[i].visible = false;
+
 		fluke::on_unmap(conn, e);
 		FLUKE_DEBUG_NOTICE(
 			"event '", tinge::fg::make_yellow("UNMAP_NOTIFY"),
@@ -260,21 +332,111 @@ namespace fluke {
 			"' for '", tinge::fg::make_yellow(fluke::to_hex(win)), "'"
 		)
 
-		// `values` here functions as a stack.
-		// We push values onto it depending on if a bitmask is satisfied
-		// for each possible option.
-		uint8_t i = 0;
-		std::array<uint32_t, 7> values{};
-
-		if (mask & XCB_CONFIG_WINDOW_X)            values[i++] = static_cast<uint32_t>(e->x);
-		if (mask & XCB_CONFIG_WINDOW_Y)            values[i++] = static_cast<uint32_t>(e->y);
-		if (mask & XCB_CONFIG_WINDOW_WIDTH)        values[i++] = e->width;
-		if (mask & XCB_CONFIG_WINDOW_HEIGHT)       values[i++] = e->height;
-		if (mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) values[i++] = e->border_width;
-		if (mask & XCB_CONFIG_WINDOW_SIBLING)      values[i++] = e->sibling;
-		if (mask & XCB_CONFIG_WINDOW_STACK_MODE)   values[i++] = e->stack_mode;
-
-		fluke::configure_window(conn, win, mask, values.data());
+		auto request = *e.get();
+
+		// Moves and resizes are paced to the refresh rate of the display the
+		// window is on. Anything else goes out straight away along with any
+		// geometry we were holding back for this window.
+		if constexpr (fluke::config::PACE_CONFIGURE_REQUESTS) {
+			constexpr uint16_t geometry =
+				XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+				XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT;
+
+			auto& pacer = conn.pacer();
+
+			// Replays don't run in real time so pacing would change what happens.
+			if (fluke::detail::replay_active) {
+				fluke::forward_configure_request(conn, request);
+				return;
+			}
+
+			if ((mask & ~geometry) == 0) {
+				const auto client = conn.windows().find(win);
+				const auto rect = client ? client->rect : fluke::Rect{ e->x, e->y, e->width, e->height };
+
+				if (pacer.hold(request, fluke::get_nearest_display(conn, rect).refresh, fluke::ConfigurePacer::clock::now())) {
+					conn.stats().configure_requests_paced++;
+					return;
+				}
+			}
+
+			else if (xcb_configure_request_event_t held; pacer.take(win, held)) {
+				fluke::merge_configure_request(held, request);
+				request = held;
+			}
+		}
+
+		fluke::forward_configure_request(conn, request);
+	}
+
+
+
+	/*
+		This event is triggered after a window has been moved, resized or restacked.
+
+		We use it to keep the window cache in sync with the server.
+	*/
+	inline void event_configure_notify(fluke::Connection& conn, const fluke::ConfigureNotifyEvent& e) {
+		const xcb_window_t win = e->window;
+
+		// Like DestroyNotify, we may see this event twice for managed windows
+		// but the update is idempotent.
+		if (conn.windows().set_rect(win, fluke::Rect{e->x, e->y, e->width, e->height})) {
+			conn.windows().set_ignored(win, e->override_redirect);
+			conn.windows().restack(win, e->above_sibling);
+		}
+
+		if (e->event != win)
+			return;
+
+		fluke::on_configure_notify(conn, e);
+		FLUKE_DEBUG_NOTICE(
+			"event '", tinge::fg::make_yellow("CONFIGURE_NOTIFY"),
+			"' for '", tinge::fg::make_yellow(fluke::to_hex(win)), "'"
+		)
+	}
+
+
+
+	/*
+		This event is triggered when a window is moved to a new parent.
+
+		Windows which leave the root window are no longer top-level so we
+		stop tracking them. Windows which are reparented to the root window
+		are tracked from now on.
+	*/
+	inline void event_reparent_notify(fluke::Connection& conn, const fluke::ReparentNotifyEvent& e) {
+		const xcb_window_t win = e->window;
+
+		if (e->parent != conn.root())
+			conn.windows().erase(win);
+
+		else
+			conn.windows().insert(fluke::Client{
+				win,
+				fluke::Rect{e->x, e->y, 0, 0},
+				false,
+				static_cast<bool>(e->override_redirect)
+			});
+
+		FLUKE_DEBUG_NOTICE(
+			"event '", tinge::fg::make_yellow("REPARENT_NOTIFY"),
+			"' for '", tinge::fg::make_yellow(fluke::to_hex(win)), "'"
+		)
+	}
+
+
+
+	/*
+		Called with the newest pointer position, either from a MotionNotify
+		or from the reply to the query which re-arms motion hints. This is
+		where features which follow the pointer belong.
+	*/
+	inline void handle_pointer_motion(fluke::Connection& conn, const fluke::Point& pointer) {
+		fluke::on_pointer(conn, pointer);
+
+		if (conn.drag().active())
+			fluke::update_drag(conn, pointer);
 	}
 
 
@@ -282,6 +444,11 @@ namespace fluke {
 	/*
 		This event is triggered every time the pointer is moved.
 		Note that this callback can be very hot.
+
+		Only the newest MotionNotify in each batch makes it here, older
+		ones are dropped by `fluke::EventBatch`. With `MOTION_HINTS` on,
+		X sends no more motion until the batch is over and we have queried
+		the pointer, see `fluke::MotionTracker`.
 	*/
 	inline void event_motion_notify(fluke::Connection& conn, const fluke::MotionNotifyEvent& e) {
 		namespace conf = fluke::config;
@@ -289,6 +456,16 @@ namespace fluke {
 		fluke::on_motion(conn, e);
 		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("MOTION_NOTIFY"), "'" )
 
+		const fluke::Point pointer{ e->root_x, e->root_y };
+
+		if (e->detail == ::XCB_MOTION_HINT)
+			conn.motion().hint(pointer);
+
+		else
+			conn.motion().moved(pointer);
+
+		fluke::handle_pointer_motion(conn, pointer);
+
 		// auto [cursor_x, cursor_y] = fluke::Point{e->root_x, e->root_y};
 		// const auto [x, y, w, h] =
 		// 	fluke::as_rect(fluke::get(conn, fluke::get_geometry(conn, fluke::get_focused_window(conn))));
@@ -304,10 +481,54 @@ namespace fluke {
 
 
 
+	/*
+		This event is triggered when one of our grabbed buttons is pressed,
+		it starts moving or resizing the window under the pointer.
+	*/
+	inline void event_button_press(fluke::Connection& conn, const fluke::ButtonPressEvent& e) {
+		namespace conf = fluke::config;
+
+		fluke::on_button_press(conn, e);
+		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("BUTTON_PRESS"), "'" )
+
+		// A second button while dragging is ignored.
+		if (conn.drag().active())
+			return;
+
+		const auto mode =
+			e->detail == conf::DRAG_MOVE_BUTTON   ? fluke::Drag::Mode::move :
+			e->detail == conf::DRAG_RESIZE_BUTTON ? fluke::Drag::Mode::resize :
+			fluke::Drag::Mode::none
+		;
+
+		if (mode == fluke::Drag::Mode::none)
+			return;
+
+		// The grab is on the root window so the window under the pointer is the child.
+		fluke::begin_drag(conn, e->child, fluke::Point{ e->root_x, e->root_y }, mode);
+	}
+
+
+
+	/*
+		This event is triggered when a button is released, it ends the drag
+		with the window at its final position.
+	*/
+	inline void event_button_release(fluke::Connection& conn, const fluke::ButtonReleaseEvent& e) {
+		fluke::on_button_release(conn, e);
+		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("BUTTON_RELEASE"), "'" )
+
+		fluke::end_drag(conn, fluke::Point{ e->root_x, e->root_y });
+	}
+
+
+
 	/*
 		This event is triggered when a property is changed, usually related to ICCCM or EWMH.
 	*/
 	inline void event_property_notify(fluke::Connection& conn, const fluke::PropertyNotifyEvent& e) {
+		// No window properties are stored in the window cache yet so
+		// there is nothing to update here.
 		fluke::on_property(conn, e);
 		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("PROPERTY_NOTIFY"), "'" )
 	}
@@ -331,6 +552,12 @@ namespace fluke {
 		We also move any windows that may be off-screen back into view.
 	*/
 	inline void event_randr_screen_change_notify(fluke::Connection& conn, const fluke::RandrScreenChangeNotifyEvent& e) {
+		// The display topology has changed, rebuild it now so that
+		// workspaces and tiled displays follow the change.
+		conn.displays().invalidate();
+		fluke::fit_workspaces_to_displays(conn);
+		fluke::fit_tiling_to_displays(conn);
+
 		fluke::on_randr_screen_change(conn, e);
 		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("RANDR_SCREEN_CHANGE_NOTIFY"), "'" )
 
@@ -340,9 +567,14 @@ namespace fluke {
 
 
 	/*
-		I'm not actually sure when this gets triggered or why.
+		This event is triggered when a CRTC, output or output property changes,
+		for example when a monitor is moved or changes mode.
 	*/
 	inline void event_randr_notify(fluke::Connection& conn, const fluke::RandrNotifyEvent& e) {
+		conn.displays().invalidate();
+		fluke::fit_workspaces_to_displays(conn);
+		fluke::fit_tiling_to_displays(conn);
+
 		fluke::on_randr_notify(conn, e);
 		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("RANDR_NOTIFY"), "'" )
 	}
@@ -355,23 +587,42 @@ namespace fluke {
 		We will call the callback function associated with a keypress we are monitoring.
 	*/
 	inline void event_keypress(fluke::Connection& conn, const fluke::KeyPressEvent& e) {
-		const xcb_keysym_t keysym = fluke::get_keysym(conn, e->detail);
-
 		fluke::on_keypress(conn, e);
 		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("KEYPRESS"), "'" )
 
-		// Remove any modifiers from a mask.
-		constexpr auto clean = [] (unsigned mask) {
-			return mask & ~(fluke::keys::caps_lock | fluke::keys::num_lock | fluke::keys::scroll_lock);
-		};
+		// Find the keybinding associated with this keycode and modifier,
+		// lock modifiers are ignored by the table.
+		const auto i = conn.keytable().find(e->detail, e->state);
 
-		// Find `fluke::Key` structure which has a matching keysym and modifier.
-		for (const auto& [mod, sym, func]: fluke::config::keybindings) {
-			if (keysym == sym and clean(mod) == clean(e->state)) {
-				func(conn);
-				return;
-			}
-		}
+		if (i == fluke::KeyTable::none)
+			return;
+
+		fluke::config::keybindings[i].func(conn);
+	}
+
+
+
+	/*
+		This event is triggered when the keyboard mapping changes, for example
+		when a new layout is loaded with `setxkbmap`.
+
+		We refresh our keysyms and grab our keybindings again since keysyms
+		may now map to different keycodes.
+	*/
+	inline void event_mapping_notify(fluke::Connection& conn, const fluke::MappingNotifyEvent& e) {
+		fluke::on_mapping(conn, e);
+		FLUKE_DEBUG_NOTICE( "event '", tinge::fg::make_yellow("MAPPING_NOTIFY"), "'" )
+
+		if (e->request != XCB_MAPPING_KEYBOARD)
+			return;
+
+		// The stand-in connection of a replay only knows the keyboard
+		// mapping we started with, asking for a new one would never return.
+		if (not conn.trace().replaying())
+			xcb_refresh_keyboard_mapping(conn.keysyms(), e.get());
+
+		if constexpr(fluke::config::keybindings.size() > 0)
+			fluke::register_keybindings(conn, fluke::config::keybindings);
 	}
 
 
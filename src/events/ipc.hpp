@@ -0,0 +1,152 @@
+#ifndef FLUKE_EVENTS_IPC_HPP
+#define FLUKE_EVENTS_IPC_HPP
+
+#pragma once
+
+#include <string_view>
+#include <cstring>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Answer a request from the control socket. Queries are answered from
+		the caches, everything else is looked up in `config::commands`.
+
+		Queries:
+			windows   every window in the window cache, bottom-most first.
+			displays  every display with its active workspace.
+			commands  every command in `config::commands`.
+			children  every program we launched which is running or finished recently.
+
+		example:
+			fluke::ipc::Reply reply;
+			fluke::handle_request(conn, request, reply);
+	*/
+	inline void handle_request(fluke::Connection& conn, fluke::ipc::Request& request, fluke::ipc::Reply& reply) {
+		using namespace fluke::ipc;
+
+		if (request.version != version or request.argc > max_args) {
+			reply.fail(Status::bad_request);
+			return;
+		}
+
+		// Don't trust the client to terminate the name.
+		request.name[max_name - 1] = '\0';
+		const std::string_view name = request.name;
+
+		FLUKE_DEBUG_NOTICE("ipc '", tinge::fg::make_yellow(name), "' with ", tinge::fg::make_yellow(request.argc), " arg(s)")
+
+		if (name == "windows") {
+			for (const auto& [win, rect, mapped, ignored]: conn.windows()) {
+				const auto crtc = conn.workspaces().display_of(win);
+
+				reply.add(Kind::windows, WindowRecord{
+					win, rect.x, rect.y, rect.w, rect.h,
+					crtc,
+					crtc == XCB_NONE ? no_workspace : static_cast<uint32_t>(conn.workspaces().index_of(win)),
+					mapped, ignored,
+					conn.workspaces().is_hidden(win),
+					conn.scratchpads().find(win) != fluke::Scratchpads::npos,
+				});
+			}
+
+			return;
+		}
+
+		if (name == "displays") {
+			// The cache may have been invalidated by randr since it was last used.
+			for (const auto& [crtc, rect, refresh]: fluke::get_displays(conn)) {
+				reply.add(Kind::displays, DisplayRecord{
+					crtc, rect.x, rect.y, rect.w, rect.h,
+					refresh,
+					static_cast<uint32_t>(conn.workspaces().active(crtc)),
+					conn.tiling().count(crtc) != 0,
+				});
+			}
+
+			return;
+		}
+
+		if (name == "commands") {
+			for (const auto& command: fluke::config::commands) {
+				CommandRecord record{ command.argc, {} };
+				std::strncpy(record.name, command.name, max_name - 1);
+
+				reply.add(Kind::commands, record);
+			}
+
+			return;
+		}
+
+		if (name == "children") {
+			for (const auto& [pid, child_name, status, running]: fluke::children()) {
+				ChildRecord record{ pid, status, running, {} };
+				std::strncpy(record.name, child_name.c_str(), max_name - 1);
+
+				reply.add(Kind::children, record);
+			}
+
+			return;
+		}
+
+		for (const auto& command: fluke::config::commands) {
+			if (name != command.name)
+				continue;
+
+			if (request.argc != command.argc or not command.func(conn, request.args))
+				reply.fail(Status::bad_arguments);
+
+			return;
+		}
+
+		reply.fail(Status::unknown_command);
+	}
+
+
+
+	/*
+		Called by the event loop when the control socket or one of its
+		clients is readable. New clients are accepted and watched, every
+		request which has arrived is answered.
+
+		Requests made by a command are flushed before its reply is sent
+		so a script which waits for the reply sees the result.
+
+		example:
+			conn.loop().wait([&conn] (int fd) {
+				fluke::handle_ipc(conn, fd);
+			});
+	*/
+	inline void handle_ipc(fluke::Connection& conn, int fd) {
+		auto& control = conn.control();
+
+		if (fd == control.fd()) {
+			for (int client = control.accept(); client != -1; client = control.accept()) {
+				if (not conn.loop().watch(client))
+					control.drop(client);
+			}
+
+			return;
+		}
+
+		if (not control.is_client(fd))
+			return;
+
+		fluke::ipc::Request request;
+
+		while (control.receive(fd, request)) {
+			conn.stats().ipc_requests++;
+
+			fluke::ipc::Reply reply;
+			fluke::handle_request(conn, request, reply);
+
+			conn.flush();
+
+			if (not control.send(fd, reply))
+				return;
+		}
+	}
+}
+
+#endif
@@ -54,7 +54,25 @@ namespace fluke {
 #include <xcb/xcb_errors.hpp>
 
 #include <structures/types.hpp>
+#include <structures/spatial_grid.hpp>
+#include <structures/window_cache.hpp>
+#include <structures/display_cache.hpp>
+#include <structures/stats.hpp>
+#include <structures/configure_pacer.hpp>
+#include <structures/children.hpp>
+#include <structures/event_loop.hpp>
+#include <structures/ipc.hpp>
+#include <structures/control_socket.hpp>
+#include <structures/workspaces.hpp>
+#include <structures/scratchpads.hpp>
+#include <config/scratchpads.hpp>
+#include <structures/drag.hpp>
+#include <structures/motion_tracker.hpp>
+#include <structures/key_table.hpp>
+#include <structures/trace.hpp>
+#include <structures/bsp_tree.hpp>
 #include <structures/connection.hpp>
+#include <structures/profile.hpp>
 #include <structures/request.hpp>
 
 #include <events/events.hpp>
@@ -62,13 +80,24 @@ namespace fluke {
 #include <utils/zip.hpp>
 #include <utils/exec.hpp>
 #include <utils/keys.hpp>
+#include <utils/pipeline.hpp>
+#include <utils/commands.hpp>
 #include <utils/functions.hpp>
+#include <utils/layout.hpp>
+#include <utils/scratchpads.hpp>
+#include <utils/drag.hpp>
+#include <utils/snapshot.hpp>
+#include <utils/restart.hpp>
 
 #include <actions.hpp>
 
 #include <config/keybindings.hpp>
 #include <config/hooks.hpp>
+#include <config/commands.hpp>
 
 #include <events/event_handlers.hpp>
+#include <events/dispatch.hpp>
+#include <events/ipc.hpp>
+#include <events/event_batch.hpp>
 
 #endif
@@ -0,0 +1,381 @@
+#ifndef FLUKE_BSP_TREE_HPP
+#define FLUKE_BSP_TREE_HPP
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		A binary space partition of a display, like bspwm.
+
+		Every leaf holds a window and every internal node splits its rect
+		between its two children either side by side or on top of each other.
+		Split ratios are stored in the nodes so they persist as windows come
+		and go.
+
+		Nodes live in a single array and refer to each other by index, freed
+		nodes are reused. A map from window to leaf lets us find a window
+		without walking the tree.
+
+		Inserting a window splits one leaf and removing a window hands its
+		parent's rect to its sibling, so only the windows in that one subtree
+		get new rects. Every function which changes the tree appends the rects
+		of the leaves it touched to `changed`, these are cell rects without
+		gaps or borders.
+
+		example:
+			fluke::BspTree tree;
+			std::vector<fluke::Placement> changed;
+
+			tree.reset(display_rect);
+			tree.insert(a, XCB_NONE, changed);
+			tree.insert(b, a, changed);
+			tree.remove(a, changed);  // `b` now takes up the whole display.
+	*/
+	class BspTree {
+		// Types
+		public:
+			using index_type = uint32_t;
+
+			static constexpr index_type none = static_cast<index_type>(-1);
+
+			struct Node {
+				fluke::Rect rect;
+
+				index_type parent = none;
+				index_type first = none;
+				index_type second = none;
+
+				xcb_window_t win = XCB_NONE;  // Only set for leaves.
+
+				float ratio = 0.5f;   // Portion of `rect` given to `first`.
+				bool vertical = true; // Children are side by side.
+
+				bool is_leaf() const noexcept {
+					return first == none;
+				}
+			};
+
+
+		// Data
+		private:
+			std::vector<Node> nodes;
+			std::vector<index_type> free_nodes;
+
+			std::unordered_map<xcb_window_t, index_type> leaves;
+
+			index_type root = none;
+			index_type last = none;  // Most recently inserted leaf.
+
+			fluke::Rect area;
+
+
+		// Helpers
+		private:
+			index_type allocate(const Node& node) {
+				if (not free_nodes.empty()) {
+					const auto i = free_nodes.back();
+					free_nodes.pop_back();
+					nodes[i] = node;
+					return i;
+				}
+
+				nodes.emplace_back(node);
+				return static_cast<index_type>(nodes.size() - 1);
+			}
+
+			void release(const index_type i) {
+				nodes[i] = Node{};
+				free_nodes.emplace_back(i);
+			}
+
+
+			// Give `rect` to node `i` and split it between its children,
+			// the rect of every leaf below `i` is appended to `changed`.
+			void update(const index_type i, const fluke::Rect& rect, std::vector<fluke::Placement>& changed) {
+				auto& node = nodes[i];
+				node.rect = rect;
+
+				if (node.is_leaf()) {
+					changed.emplace_back(fluke::Placement{ node.win, rect });
+					return;
+				}
+
+				const auto [x, y, w, h] = rect;
+
+				if (node.vertical) {
+					const int first_w = static_cast<int>(float(w) * node.ratio);
+					const auto first = node.first, second = node.second;
+
+					update(first, fluke::Rect{ x, y, first_w, h }, changed);
+					update(second, fluke::Rect{ x + first_w, y, w - first_w, h }, changed);
+				}
+
+				else {
+					const int first_h = static_cast<int>(float(h) * node.ratio);
+					const auto first = node.first, second = node.second;
+
+					update(first, fluke::Rect{ x, y, w, first_h }, changed);
+					update(second, fluke::Rect{ x, y + first_h, w, h - first_h }, changed);
+				}
+			}
+
+
+		// Functions
+		public:
+			// Remove every window and set the area to partition.
+			void reset(const fluke::Rect& area_) {
+				nodes.clear();
+				free_nodes.clear();
+				leaves.clear();
+
+				root = none;
+				last = none;
+				area = area_;
+			}
+
+
+			// Change the area to partition, every window gets a new rect.
+			void resize(const fluke::Rect& area_, std::vector<fluke::Placement>& changed) {
+				area = area_;
+
+				if (root != none)
+					update(root, area, changed);
+			}
+
+
+			bool contains(const xcb_window_t win) const {
+				return leaves.find(win) != leaves.end();
+			}
+
+			auto size() const noexcept {
+				return leaves.size();
+			}
+
+			const fluke::Rect& rect() const noexcept {
+				return area;
+			}
+
+
+			// Raw nodes, freed nodes have no parent and aren't the root.
+			const std::vector<Node>& data() const noexcept {
+				return nodes;
+			}
+
+			index_type root_index() const noexcept {
+				return root;
+			}
+
+			index_type last_index() const noexcept {
+				return last;
+			}
+
+
+			/*
+				Replace the tree with nodes saved from `data()`, returns false
+				if the nodes don't form a valid tree. Nothing is laid out, the
+				windows are expected to already be in place.
+
+				The nodes may come from a file so every link is checked: the
+				tree reachable from `root_` must agree on parent and child links,
+				have no cycles, hold every window once and only use ratios
+				between 0 and 1. Unreachable nodes are freed.
+			*/
+			bool restore(const fluke::Rect& area_, std::vector<Node>&& nodes_, const index_type root_, const index_type last_) {
+				reset(area_);
+
+				const auto valid = [&] (const index_type i) {
+					return i == none or i < nodes_.size();
+				};
+
+				if (not valid(root_) or not valid(last_))
+					return false;
+
+				for (const auto& node: nodes_) {
+					if (not valid(node.parent) or not valid(node.first) or not valid(node.second))
+						return false;
+				}
+
+				std::vector<bool> reachable(nodes_.size(), false);
+				std::unordered_map<xcb_window_t, index_type> found;
+
+				if (root_ != none) {
+					if (nodes_[root_].parent != none)
+						return false;
+
+					std::vector<index_type> pending{ root_ };
+
+					while (not pending.empty()) {
+						const auto i = pending.back();
+						pending.pop_back();
+
+						// Reaching a node twice means a cycle or a shared child.
+						if (reachable[i])
+							return false;
+
+						reachable[i] = true;
+
+						const auto& node = nodes_[i];
+
+						if (node.is_leaf()) {
+							if (node.second != none or node.win == XCB_NONE or not found.emplace(node.win, i).second)
+								return false;
+
+							continue;
+						}
+
+						if (
+							node.second == none or
+							not (node.ratio > 0.0f and node.ratio < 1.0f) or
+							nodes_[node.first].parent != i or
+							nodes_[node.second].parent != i
+						)
+							return false;
+
+						pending.emplace_back(node.first);
+						pending.emplace_back(node.second);
+					}
+				}
+
+				if (last_ != none and not (reachable[last_] and nodes_[last_].is_leaf()))
+					return false;
+
+				nodes = std::move(nodes_);
+				leaves = std::move(found);
+				root = root_;
+				last = last_;
+
+				for (index_type i = 0; i < nodes.size(); ++i) {
+					if (reachable[i])
+						continue;
+
+					nodes[i] = Node{};
+					free_nodes.emplace_back(i);
+				}
+
+				return true;
+			}
+
+
+			/*
+				Add `win` by splitting the leaf of `target` in two, the split
+				is made across the longer side of the leaf. If `target` isn't
+				in the tree, the most recently inserted leaf is split instead.
+			*/
+			void insert(const xcb_window_t win, const xcb_window_t target, std::vector<fluke::Placement>& changed) {
+				if (contains(win))
+					return;
+
+				if (root == none) {
+					root = last = allocate(Node{ area, none, none, none, win });
+					leaves.emplace(win, root);
+					update(root, area, changed);
+					return;
+				}
+
+				const auto it = leaves.find(target);
+				const index_type split = it != leaves.end() ? it->second : last;
+
+				// The leaf becomes an internal node and its window moves to a new leaf.
+				const auto rect = nodes[split].rect;
+				const auto old_win = nodes[split].win;
+
+				const auto first = allocate(Node{ {}, split, none, none, old_win });
+				const auto second = allocate(Node{ {}, split, none, none, win });
+
+				auto& node = nodes[split];
+				node.first = first;
+				node.second = second;
+				node.win = XCB_NONE;
+				node.vertical = rect.w >= rect.h;
+
+				leaves[old_win] = first;
+				leaves.emplace(win, second);
+				last = second;
+
+				update(split, rect, changed);
+			}
+
+
+			/*
+				Remove `win`, its sibling takes over the rect of their parent.
+			*/
+			void remove(const xcb_window_t win, std::vector<fluke::Placement>& changed) {
+				const auto it = leaves.find(win);
+
+				if (it == leaves.end())
+					return;
+
+				const auto leaf = it->second;
+				leaves.erase(it);
+
+				const auto parent = nodes[leaf].parent;
+				release(leaf);
+
+				if (parent == none) {
+					root = last = none;
+					return;
+				}
+
+				// Move the sibling up into the place of the parent.
+				const auto sibling = nodes[parent].first == leaf ? nodes[parent].second : nodes[parent].first;
+				const auto grandparent = nodes[parent].parent;
+				const auto rect = nodes[parent].rect;
+
+				nodes[sibling].parent = grandparent;
+
+				if (grandparent == none)
+					root = sibling;
+
+				else if (nodes[grandparent].first == parent)
+					nodes[grandparent].first = sibling;
+
+				else
+					nodes[grandparent].second = sibling;
+
+				release(parent);
+
+				if (last == leaf or last == parent)
+					last = sibling;
+
+				// If the sibling is a subtree, keep splitting its newest leaf.
+				while (not nodes[last].is_leaf())
+					last = nodes[last].second;
+
+				update(sibling, rect, changed);
+			}
+
+
+			/*
+				Change the split ratio of the parent of `win` by `delta`,
+				the ratio is kept between 0.1 and 0.9.
+			*/
+			void adjust_ratio(const xcb_window_t win, const float delta, std::vector<fluke::Placement>& changed) {
+				const auto it = leaves.find(win);
+
+				if (it == leaves.end())
+					return;
+
+				const auto parent = nodes[it->second].parent;
+
+				if (parent == none)
+					return;
+
+				auto& node = nodes[parent];
+
+				// Growing the second child means shrinking the first.
+				const float sign = node.first == it->second ? 1.0f : -1.0f;
+				node.ratio = std::clamp(node.ratio + delta * sign, 0.1f, 0.9f);
+
+				update(parent, node.rect, changed);
+			}
+	};
+}
+
+#endif
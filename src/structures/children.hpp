@@ -0,0 +1,138 @@
+#ifndef FLUKE_CHILDREN_HPP
+#define FLUKE_CHILDREN_HPP
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <sys/types.h>
+	#include <sys/wait.h>
+}
+
+
+namespace fluke {
+	/*
+		Every program we have launched which is still running, along with
+		the exit status of the ones which finished most recently.
+
+		Children are reaped by `reap` when the event loop reads SIGCHLD,
+		so nothing we launch is left behind as a zombie. Only the newest
+		`max_finished` finished children are remembered.
+
+		example:
+			for (const auto& [pid, name, status, running]: fluke::children())
+				std::cout << pid << ' ' << name << '\n';
+	*/
+	class Children {
+		// Types
+		public:
+			struct Child {
+				pid_t pid;
+				std::string name;
+
+				int status;    // As returned by `waitpid`, only valid once the child is done.
+				bool running;
+			};
+
+			static constexpr size_t max_finished = 32;
+
+
+		// Data
+		private:
+			// Oldest first.
+			std::vector<Child> children;
+
+			size_t finished = 0;
+
+
+		// Functions
+		public:
+			void add(const pid_t pid, const char* name) {
+				children.emplace_back(Child{ pid, name, 0, true });
+			}
+
+
+			/*
+				Collect the exit status of every child which has finished,
+				never blocks. Children we didn't launch through `fluke::exec`
+				are reaped too but aren't remembered.
+			*/
+			void reap() {
+				int status = 0;
+				pid_t pid = 0;
+
+				while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+					const auto it = std::find_if(children.begin(), children.end(), [pid] (const auto& c) {
+						return c.running and c.pid == pid;
+					});
+
+					if (it == children.end())
+						continue;
+
+					FLUKE_DEBUG_NOTICE_SUB(
+						"child '", tinge::fg::make_yellow(it->name), "' (", pid, ") exited with ",
+						WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status)
+					)
+
+					it->status = status;
+					it->running = false;
+
+					finished++;
+				}
+
+				// Forget the oldest finished children.
+				while (finished > max_finished) {
+					const auto it = std::find_if(children.begin(), children.end(), [] (const auto& c) {
+						return not c.running;
+					});
+
+					children.erase(it);
+					finished--;
+				}
+			}
+
+
+			// True until `pid` has been reaped.
+			bool running(const pid_t pid) const {
+				return std::any_of(children.begin(), children.end(), [pid] (const auto& c) {
+					return c.running and c.pid == pid;
+				});
+			}
+
+
+			auto size() const noexcept {
+				return children.size();
+			}
+
+
+		// Iterators
+		public:
+			auto begin() const noexcept { return children.begin(); }
+			auto end() const noexcept { return children.end(); }
+	};
+
+
+
+	namespace detail {
+		// Launching is done from hooks and keybindings which don't always
+		// have the connection at hand, there is only ever one table.
+		inline fluke::Children children;
+	}
+
+
+	/*
+		The table of programs launched by `fluke::exec`.
+
+		example:
+			fluke::children().reap();
+	*/
+	inline fluke::Children& children() noexcept {
+		return fluke::detail::children;
+	}
+}
+
+#endif
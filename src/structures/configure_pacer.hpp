@@ -0,0 +1,228 @@
+#ifndef FLUKE_CONFIGURE_PACER_HPP
+#define FLUKE_CONFIGURE_PACER_HPP
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Merge the configure request `src` into `dst`, newer values win.
+
+		example:
+			fluke::merge_configure_request(older, newer);
+	*/
+	inline void merge_configure_request(xcb_configure_request_event_t& dst, const xcb_configure_request_event_t& src) {
+		const uint16_t mask = src.value_mask;
+
+		if (mask & XCB_CONFIG_WINDOW_X)            dst.x = src.x;
+		if (mask & XCB_CONFIG_WINDOW_Y)            dst.y = src.y;
+		if (mask & XCB_CONFIG_WINDOW_WIDTH)        dst.width = src.width;
+		if (mask & XCB_CONFIG_WINDOW_HEIGHT)       dst.height = src.height;
+		if (mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) dst.border_width = src.border_width;
+		if (mask & XCB_CONFIG_WINDOW_SIBLING)      dst.sibling = src.sibling;
+		if (mask & XCB_CONFIG_WINDOW_STACK_MODE)   dst.stack_mode = src.stack_mode;
+
+		dst.value_mask |= mask;
+	}
+
+
+
+	/*
+		Limits geometry changes from ConfigureRequests to one per window
+		per refresh of the display the window is on.
+
+		Programs like `xmmv` send a new position for every pointer motion,
+		most of which would never make it to the screen. The first request
+		in a refresh interval is forwarded straight away, later ones are
+		merged and held until the interval is over so the newest geometry
+		always lands. The event loop waits no longer than `deadline()` and
+		then forwards whatever `take_due` hands back.
+
+		example:
+			auto& pacer = conn.pacer();
+
+			if (not pacer.hold(*e, refresh, now))
+				fluke::forward_configure_request(conn, *e);
+
+			pacer.take_due(now, [&] (const auto& request) {
+				fluke::forward_configure_request(conn, request);
+			});
+	*/
+	class ConfigurePacer {
+		// Types
+		public:
+			using clock = std::chrono::steady_clock;
+
+
+		private:
+			struct Entry {
+				xcb_window_t win;
+
+				clock::time_point next;   // Earliest time we may forward again.
+				clock::duration interval;
+
+				xcb_configure_request_event_t request;
+				bool held;
+			};
+
+
+		// Data
+		private:
+			// Only windows which are being dragged are in here so a flat
+			// vector is cheaper than a map.
+			std::vector<Entry> entries;
+
+			size_t held_count = 0;
+
+
+		// Helpers
+		private:
+			Entry* find(const xcb_window_t win) {
+				for (auto& entry: entries) {
+					if (entry.win == win)
+						return &entry;
+				}
+
+				return nullptr;
+			}
+
+
+		// Functions
+		public:
+			/*
+				Decide whether `request` should be held back. Returns false if
+				it should be forwarded now, in which case the window may not
+				move again until `interval` has passed.
+			*/
+			bool hold(const xcb_configure_request_event_t& request, const uint64_t interval, const clock::time_point now) {
+				auto entry = find(request.window);
+
+				if (not entry) {
+					entries.emplace_back(Entry{ request.window, now + std::chrono::nanoseconds{interval}, std::chrono::nanoseconds{interval}, {}, false });
+					return false;
+				}
+
+				entry->interval = std::chrono::nanoseconds{interval};
+
+				if (now >= entry->next and not entry->held) {
+					entry->next = now + entry->interval;
+					return false;
+				}
+
+				if (entry->held) {
+					fluke::merge_configure_request(entry->request, request);
+				}
+
+				else {
+					entry->request = request;
+					entry->held = true;
+					held_count++;
+				}
+
+				return true;
+			}
+
+
+			/*
+				Take the held request of `win` if there is one, it should be
+				merged into a request which is about to be forwarded.
+			*/
+			bool take(const xcb_window_t win, xcb_configure_request_event_t& out) {
+				auto entry = find(win);
+
+				if (not entry or not entry->held)
+					return false;
+
+				out = entry->request;
+				entry->held = false;
+				held_count--;
+
+				return true;
+			}
+
+
+			/*
+				Call `func` with every held request whose interval is over.
+				Windows which have been idle for a whole interval are forgotten.
+			*/
+			template <typename F>
+			void take_due(const clock::time_point now, F&& func) {
+				for (size_t i = 0; i < entries.size();) {
+					auto& entry = entries[i];
+
+					if (now < entry.next) {
+						++i;
+						continue;
+					}
+
+					if (not entry.held) {
+						entry = entries.back();
+						entries.pop_back();
+						continue;
+					}
+
+					entry.held = false;
+					entry.next = now + entry.interval;
+					held_count--;
+
+					func(entry.request);
+					++i;
+				}
+			}
+
+
+			// Call `func` with every held request whether it is due or not
+			// and forget about every window.
+			template <typename F>
+			void take_all(F&& func) {
+				for (const auto& entry: entries) {
+					if (entry.held)
+						func(entry.request);
+				}
+
+				entries.clear();
+				held_count = 0;
+			}
+
+
+			// Forget about a window, it has been destroyed.
+			void erase(const xcb_window_t win) {
+				for (size_t i = 0; i < entries.size(); ++i) {
+					if (entries[i].win != win)
+						continue;
+
+					if (entries[i].held)
+						held_count--;
+
+					entries[i] = entries.back();
+					entries.pop_back();
+					return;
+				}
+			}
+
+
+			// Time at which the next held request is due or `time_point::max()`.
+			clock::time_point deadline() const noexcept {
+				auto earliest = clock::time_point::max();
+
+				for (const auto& entry: entries) {
+					if (entry.held and entry.next < earliest)
+						earliest = entry.next;
+				}
+
+				return earliest;
+			}
+
+
+			bool pending() const noexcept {
+				return held_count != 0;
+			}
+	};
+}
+
+#endif
@@ -4,8 +4,14 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <fluke.hpp>
 
+extern "C" {
+	#include <fcntl.h>
+}
+
 
 namespace fluke {
 	// namespace detail {
@@ -22,27 +28,123 @@ namespace fluke {
 			// with the X server is done.
 
 			// We also hold onto a pointer to keysymbols which we use for registering
-			// keybindings and handling them on a keypress
+			// keybindings and handling them on a keypress along with a table
+			// which maps keycodes straight to keybindings.
 
 			// We keep a pointer to the main screen, we can use this to get
 			// the root window ID.
 
+			// The window cache mirrors the children of the root window and the
+			// display cache mirrors the randr topology so that we don't need
+			// to ask X for them every time.
+
+			// Displays which are tiled have a BSP tree, keyed by their CRTC.
+			// Every display also has its own set of workspaces.
+
+			// Scratchpads remember which window belongs to which configured program.
+
+			// A window which is being moved or resized with the pointer and
+			// the newest pointer position we know of.
+
+			// ConfigureRequests which are being paced to the display refresh
+			// rate are held by the pacer.
+
+			// The event loop waits on X, signals and timers. It is only opened
+			// for live sessions.
+
+			// Scripts talk to us through the control socket.
+
+			// We also keep some statistics about the event loop around.
+
+			// Actions can't restart fluke from inside of an event handler so
+			// they ask for a restart which the event loop carries out.
+
+			// The trace records everything we receive from X when enabled. When
+			// replaying, it is created before the connection because the
+			// stand-in connection is built from it.
+
+			fluke::Trace event_trace;
+
 			std::unique_ptr<xcb_connection_t, decltype(&xcb_disconnect)> conn;
 			std::unique_ptr<xcb_key_symbols_t, decltype(&xcb_key_symbols_free)> key_symbols;
+			fluke::KeyTable key_table;
 
 			xcb_screen_t* scrn;
 
+			fluke::WindowCache window_cache;
+			fluke::DisplayCache display_cache;
+
+			std::unordered_map<xcb_randr_crtc_t, fluke::BspTree> tiling_trees;
+			fluke::Workspaces workspace_list;
+			fluke::Scratchpads scratchpad_list;
+			fluke::Drag drag_state;
+			fluke::MotionTracker motion_tracker;
+
+			fluke::ConfigurePacer configure_pacer;
+			fluke::EventLoop event_loop;
+			fluke::ControlSocket control_socket;
+
+			fluke::Stats statistics;
+
+			bool restart_pending = false;
+
 
 		// Constructor
 		public:
 			Connection():
-				conn(xcb_connect(nullptr, nullptr), &xcb_disconnect),
+				Connection(xcb_connect(nullptr, nullptr))
+			{
+
+			}
+
+			// Replay a trace against a stand-in connection.
+			explicit Connection(fluke::Trace&& trace):
+				event_trace(std::move(trace)),
+				conn(fluke::replay_connection(event_trace), &xcb_disconnect),
 				key_symbols(xcb_key_symbols_alloc(conn.get()), &xcb_key_symbols_free),
-				scrn(xcb_setup_roots_iterator(xcb_get_setup(conn.get())).data)
+				key_table(),
+				scrn(xcb_setup_roots_iterator(xcb_get_setup(conn.get())).data),
+				window_cache(fluke::Rect{ 0, 0, scrn->width_in_pixels, scrn->height_in_pixels }),
+				display_cache(),
+				tiling_trees(),
+				workspace_list(),
+				scratchpad_list(fluke::config::scratchpads.size()),
+				drag_state(),
+				motion_tracker(),
+				configure_pacer(),
+				event_loop(),
+				control_socket(),
+				statistics(),
+				restart_pending(false)
 			{
 
 			}
 
+			explicit Connection(xcb_connection_t* conn_):
+				event_trace(),
+				conn(conn_, &xcb_disconnect),
+				key_symbols(xcb_key_symbols_alloc(conn.get()), &xcb_key_symbols_free),
+				key_table(),
+				scrn(xcb_setup_roots_iterator(xcb_get_setup(conn.get())).data),
+				window_cache(fluke::Rect{ 0, 0, scrn->width_in_pixels, scrn->height_in_pixels }),
+				display_cache(),
+				tiling_trees(),
+				workspace_list(),
+				scratchpad_list(fluke::config::scratchpads.size()),
+				drag_state(),
+				motion_tracker(),
+				configure_pacer(),
+				event_loop(),
+				control_socket(),
+				statistics(),
+				restart_pending(false)
+			{
+				// Programs we launch and the process we restart into mustn't
+				// inherit our connection to X.
+				if (const int fd = xcb_get_file_descriptor(conn.get()); fd != -1)
+					fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+			}
+
 
 		// Implicit cast operators
 		public:
@@ -61,6 +163,10 @@ namespace fluke {
 				return key_symbols.get();
 			}
 
+			fluke::KeyTable& keytable() noexcept {
+				return key_table;
+			}
+
 			constexpr xcb_window_t root() const noexcept {
 				return scrn->root;
 			}
@@ -69,6 +175,67 @@ namespace fluke {
 				return scrn;
 			}
 
+			fluke::WindowCache& windows() noexcept {
+				return window_cache;
+			}
+
+			const fluke::WindowCache& windows() const noexcept {
+				return window_cache;
+			}
+
+			fluke::DisplayCache& displays() noexcept {
+				return display_cache;
+			}
+
+			auto& tiling() noexcept {
+				return tiling_trees;
+			}
+
+			fluke::Workspaces& workspaces() noexcept {
+				return workspace_list;
+			}
+
+			fluke::Scratchpads& scratchpads() noexcept {
+				return scratchpad_list;
+			}
+
+			fluke::Drag& drag() noexcept {
+				return drag_state;
+			}
+
+			fluke::MotionTracker& motion() noexcept {
+				return motion_tracker;
+			}
+
+			fluke::ConfigurePacer& pacer() noexcept {
+				return configure_pacer;
+			}
+
+			fluke::EventLoop& loop() noexcept {
+				return event_loop;
+			}
+
+			fluke::ControlSocket& control() noexcept {
+				return control_socket;
+			}
+
+			fluke::Stats& stats() noexcept {
+				return statistics;
+			}
+
+			fluke::Trace& trace() noexcept {
+				return event_trace;
+			}
+
+			// Ask the event loop to restart fluke after the current batch.
+			void request_restart(const bool pending = true) noexcept {
+				restart_pending = pending;
+			}
+
+			bool restart_requested() const noexcept {
+				return restart_pending;
+			}
+
 			// Flush all pending requests.
 			void flush() noexcept {
 				xcb_flush(conn.get());
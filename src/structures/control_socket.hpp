@@ -0,0 +1,172 @@
+#ifndef FLUKE_CONTROL_SOCKET_HPP
+#define FLUKE_CONTROL_SOCKET_HPP
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <sys/socket.h>
+	#include <sys/stat.h>
+	#include <sys/un.h>
+}
+
+
+namespace fluke {
+	/*
+		The listening end of the control socket and every client connected
+		to it. Every socket is non-blocking and watched by the event loop,
+		see `fluke::handle_ipc` for how requests are answered.
+
+		example:
+			auto& control = conn.control();
+
+			if (control.open(fluke::runtime_path(".socket")))
+				conn.loop().watch(control.fd());
+	*/
+	class ControlSocket {
+		// Data
+		private:
+			int listen_fd = -1;
+			std::string socket_path;
+
+			std::vector<int> clients;
+
+
+		// Constructors
+		public:
+			ControlSocket() = default;
+
+			ControlSocket(const ControlSocket&) = delete;
+			ControlSocket& operator=(const ControlSocket&) = delete;
+
+			~ControlSocket() {
+				for (const int client: clients)
+					close(client);
+
+				if (listen_fd != -1) {
+					close(listen_fd);
+					unlink(socket_path.c_str());
+				}
+			}
+
+
+		// Functions
+		public:
+			/*
+				Listen on `path`. A socket left behind by an earlier instance
+				is replaced, there can only be one window manager per display.
+				Only our user may connect.
+			*/
+			bool open(const std::string& path) {
+				sockaddr_un addr{};
+				addr.sun_family = AF_UNIX;
+
+				if (path.size() >= sizeof(addr.sun_path))
+					return false;
+
+				std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+				const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+				if (fd == -1)
+					return false;
+
+				unlink(path.c_str());
+
+				if (
+					bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == -1 or
+					chmod(path.c_str(), S_IRUSR | S_IWUSR) == -1 or
+					listen(fd, 16) == -1
+				) {
+					close(fd);
+					return false;
+				}
+
+				listen_fd = fd;
+				socket_path = path;
+
+				return true;
+			}
+
+
+			bool is_open() const noexcept {
+				return listen_fd != -1;
+			}
+
+			int fd() const noexcept {
+				return listen_fd;
+			}
+
+			const std::string& path() const noexcept {
+				return socket_path;
+			}
+
+
+			// Accept a waiting client, returns -1 if there are none.
+			int accept() {
+				const int client = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+				if (client != -1)
+					clients.emplace_back(client);
+
+				return client;
+			}
+
+
+			bool is_client(const int fd) const {
+				return std::find(clients.begin(), clients.end(), fd) != clients.end();
+			}
+
+
+			// Hang up on a client, closing it also removes it from the event loop.
+			void drop(const int fd) {
+				const auto it = std::find(clients.begin(), clients.end(), fd);
+
+				if (it == clients.end())
+					return;
+
+				close(fd);
+
+				*it = clients.back();
+				clients.pop_back();
+			}
+
+
+			/*
+				Read the next request from a client. Returns false if there
+				are no more requests for now, clients which hung up or sent
+				something which isn't a request are dropped.
+			*/
+			bool receive(const int fd, fluke::ipc::Request& request) {
+				const auto length = recv(fd, &request, sizeof(request), 0);
+
+				if (length == sizeof(request))
+					return true;
+
+				if (length == -1 and (errno == EAGAIN or errno == EWOULDBLOCK))
+					return false;
+
+				drop(fd);
+				return false;
+			}
+
+
+			// Send a reply, clients which aren't reading their replies are dropped.
+			bool send(const int fd, const fluke::ipc::Reply& reply) {
+				if (::send(fd, reply.data(), reply.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(reply.size()))
+					return true;
+
+				drop(fd);
+				return false;
+			}
+	};
+}
+
+#endif
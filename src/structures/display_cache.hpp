@@ -0,0 +1,173 @@
+#ifndef FLUKE_DISPLAY_CACHE_HPP
+#define FLUKE_DISPLAY_CACHE_HPP
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	// A connected display, this is an active CRTC with at least one connected output.
+	struct Display {
+		xcb_randr_crtc_t crtc;
+		fluke::Rect rect;
+
+		// Nanoseconds between refreshes of the current mode.
+		uint64_t refresh = default_refresh;
+
+		static constexpr uint64_t default_refresh = 1'000'000'000 / 60;
+	};
+
+
+
+	/*
+		Nanoseconds between refreshes of a randr mode.
+
+		example:
+			auto ns = fluke::refresh_interval(mode_info);
+	*/
+	inline uint64_t refresh_interval(const xcb_randr_mode_info_t& mode) {
+		uint64_t vtotal = mode.vtotal;
+
+		if (mode.mode_flags & XCB_RANDR_MODE_FLAG_DOUBLE_SCAN)
+			vtotal *= 2;
+
+		if (mode.mode_flags & XCB_RANDR_MODE_FLAG_INTERLACE)
+			vtotal /= 2;
+
+		const uint64_t pixels = uint64_t{mode.htotal} * vtotal;
+
+		if (mode.dot_clock == 0 or pixels == 0)
+			return fluke::Display::default_refresh;
+
+		return pixels * 1'000'000'000 / mode.dot_clock;
+	}
+
+
+
+	/*
+		A client-side copy of the display topology.
+
+		Asking randr about the displays takes several round trips so we do
+		it once and keep the result around until randr tells us that something
+		has changed. The cache is only ever invalidated by randr events and
+		rebuilt lazily the next time it is needed.
+
+		Use `fluke::get_displays(conn)` rather than reading this directly
+		so that the cache is rebuilt when it is stale.
+
+		example:
+			for (const auto& [crtc, rect, refresh]: fluke::get_displays(conn))
+				std::cout << rect << '\n';
+	*/
+	class DisplayCache {
+		// Data
+		private:
+			std::vector<fluke::Display> displays;
+			bool valid = false;
+
+			// Refresh interval of every mode, only used while rebuilding.
+			std::vector<std::pair<xcb_randr_mode_t, uint64_t>> modes;
+
+			// Number of displays at the front of `displays` which have a
+			// connected output, only used while rebuilding.
+			size_t connected = 0;
+
+
+		// Functions
+		public:
+			void assign(std::vector<fluke::Display>&& new_displays) {
+				displays = std::move(new_displays);
+				valid = true;
+			}
+
+			/*
+				Rebuild the cache in place, see `fluke::request_display_cache`.
+				Every active CRTC is added and then moved to the front once a
+				connected output is found for it, `commit` drops the rest.
+				A CRTC shared by several outputs is only kept once.
+			*/
+			void rebuild() noexcept {
+				displays.clear();
+				modes.clear();
+				connected = 0;
+				valid = false;
+			}
+
+			void add_mode(const xcb_randr_mode_info_t& mode) {
+				modes.emplace_back(mode.id, fluke::refresh_interval(mode));
+			}
+
+			// Add an active CRTC, its refresh interval is looked up from the modes.
+			void add(fluke::Display disp, const xcb_randr_mode_t mode) {
+				for (const auto& [id, refresh]: modes) {
+					if (id == mode)
+						disp.refresh = refresh;
+				}
+
+				displays.emplace_back(disp);
+			}
+
+			void connect(const xcb_randr_crtc_t crtc) noexcept {
+				for (size_t i = connected; i < displays.size(); ++i) {
+					if (displays[i].crtc == crtc) {
+						std::swap(displays[i], displays[connected++]);
+						return;
+					}
+				}
+			}
+
+			void commit() {
+				displays.resize(connected);
+				modes.clear();
+				valid = true;
+			}
+
+
+			void invalidate() noexcept {
+				valid = false;
+			}
+
+			bool is_valid() const noexcept {
+				return valid;
+			}
+
+			auto size() const noexcept {
+				return displays.size();
+			}
+
+			const fluke::Display& operator[](const size_t i) const {
+				return displays[i];
+			}
+
+			// Smallest rect which covers every display.
+			fluke::Rect bounds() const noexcept {
+				if (displays.empty())
+					return fluke::Rect{};
+
+				int x0 = displays.front().rect.x, y0 = displays.front().rect.y;
+				int x1 = x0, y1 = y0;
+
+				for (const auto& [crtc, rect, refresh]: displays) {
+					x0 = std::min<int>(x0, rect.x);
+					y0 = std::min<int>(y0, rect.y);
+					x1 = std::max<int>(x1, rect.x + rect.w);
+					y1 = std::max<int>(y1, rect.y + rect.h);
+				}
+
+				return fluke::Rect{ x0, y0, x1 - x0, y1 - y0 };
+			}
+
+
+		// Iterators
+		public:
+			auto begin() const noexcept { return displays.begin(); }
+			auto end() const noexcept { return displays.end(); }
+	};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef FLUKE_DRAG_HPP
+#define FLUKE_DRAG_HPP
+
+#pragma once
+
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		State of an interactive move or resize which is driven by the
+		pointer, see `fluke::begin_drag`.
+
+		`origin` is where the pointer was when the drag started and `start`
+		is the rect of the window at that time, every motion is applied to
+		`start` so rounding and snapping never accumulate. `rect` is the
+		last geometry we asked for.
+
+		example:
+			if (conn.drag().active())
+				fluke::update_drag(conn, fluke::Point{ e->root_x, e->root_y });
+	*/
+	struct Drag {
+		enum class Mode {
+			none,
+			move,
+			resize,
+		};
+
+		xcb_window_t win = XCB_NONE;
+		Mode mode = Mode::none;
+
+		fluke::Point origin;
+		fluke::Rect start;
+		fluke::Rect rect;
+
+
+		bool active() const noexcept {
+			return mode != Mode::none;
+		}
+
+		void reset() noexcept {
+			*this = Drag{};
+		}
+	};
+}
+
+#endif
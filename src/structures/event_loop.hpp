@@ -0,0 +1,350 @@
+#ifndef FLUKE_EVENT_LOOP_HPP
+#define FLUKE_EVENT_LOOP_HPP
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <sys/epoll.h>
+	#include <sys/signalfd.h>
+	#include <sys/timerfd.h>
+}
+
+
+namespace fluke {
+	/*
+		A one-shot timer on `CLOCK_MONOTONIC` which can be waited on by
+		`fluke::EventLoop` like any other file, use it for deferred or
+		debounced work instead of waking up to check.
+
+		example:
+			fluke::Timer timer;
+
+			timer.arm(std::chrono::steady_clock::now() + std::chrono::milliseconds{100});
+			conn.loop().watch(timer.fd());
+	*/
+	class Timer {
+		// Types
+		public:
+			using clock = std::chrono::steady_clock;
+
+
+		// Data
+		private:
+			int timer_fd = -1;
+			clock::time_point armed_at = clock::time_point::max();
+
+
+		// Constructors
+		public:
+			Timer():
+				timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+			{
+
+			}
+
+			Timer(const Timer&) = delete;
+			Timer& operator=(const Timer&) = delete;
+
+			~Timer() {
+				if (timer_fd != -1)
+					close(timer_fd);
+			}
+
+
+		// Functions
+		public:
+			int fd() const noexcept {
+				return timer_fd;
+			}
+
+
+			// Expire at `deadline`, deadlines in the past expire straight
+			// away. Re-arming with the same deadline is free.
+			void arm(const clock::time_point deadline) noexcept {
+				if (deadline == armed_at)
+					return;
+
+				armed_at = deadline;
+
+				// `steady_clock` is `CLOCK_MONOTONIC` so the deadline can be
+				// used as an absolute time. Zero would disarm the timer.
+				const auto ns = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(
+					deadline.time_since_epoch()
+				).count());
+
+				itimerspec spec{};
+				spec.it_value.tv_sec = static_cast<time_t>(ns / 1'000'000'000);
+				spec.it_value.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+
+				timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+			}
+
+
+			void disarm() noexcept {
+				if (armed_at == clock::time_point::max())
+					return;
+
+				armed_at = clock::time_point::max();
+
+				const itimerspec spec{};
+				timerfd_settime(timer_fd, 0, &spec, nullptr);
+			}
+
+
+			// Acknowledge an expiry so the timer stops being readable.
+			void consume() noexcept {
+				uint64_t expirations = 0;
+
+				if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+					armed_at = clock::time_point::max();
+			}
+	};
+
+
+
+	/*
+		Waits on the X connection, signals, timers and any other file we
+		are asked to watch, all at once with `epoll`. Nothing wakes us up
+		unless there is work to do.
+
+		Signals we care about are blocked and read from a `signalfd` so they
+		are handled between events like everything else rather than in the
+		middle of whatever we were doing:
+
+		- SIGINT, SIGTERM and SIGHUP stop the event loop.
+		- SIGUSR1 asks for statistics to be printed.
+		- SIGCHLD reaps programs we have launched, see `fluke::Children`.
+
+		The loop is only opened for live sessions, replaying a trace never
+		waits on anything.
+
+		example:
+			auto& loop = conn.loop();
+
+			loop.open(xcb_get_file_descriptor(conn));
+
+			loop.wait([] (int fd) {
+				// A watched file is ready.
+			});
+	*/
+	class EventLoop {
+		// Data
+		private:
+			int epoll_fd = -1;
+			int signal_fd = -1;
+			int x_fd = -1;
+
+			fluke::Timer pacer_timer;
+
+			// The signal mask from before we blocked the signals we handle.
+			sigset_t original_mask;
+			bool masked = false;
+
+			bool stop_requested = false;
+			bool stats_requested = false;
+			int exit_status = EXIT_SUCCESS;
+
+
+		// Helpers
+		private:
+			static sigset_t handled_signals() noexcept {
+				sigset_t set;
+				sigemptyset(&set);
+
+				sigaddset(&set, SIGINT);
+				sigaddset(&set, SIGTERM);
+				sigaddset(&set, SIGHUP);
+				sigaddset(&set, SIGUSR1);
+				sigaddset(&set, SIGCHLD);
+
+				return set;
+			}
+
+
+			void handle_signals() noexcept {
+				signalfd_siginfo info;
+
+				while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+					switch (info.ssi_signo) {
+						case SIGINT:  FLUKE_DEBUG_WARN("SIGINT")  stop(EXIT_FAILURE); break;
+						case SIGTERM: FLUKE_DEBUG_WARN("SIGTERM") stop(EXIT_FAILURE); break;
+						case SIGHUP:  FLUKE_DEBUG_WARN("SIGHUP")  stop(EXIT_FAILURE); break;
+
+						case SIGUSR1: stats_requested = true; break;
+						case SIGCHLD: fluke::children().reap(); break;
+
+						default: break;
+					}
+				}
+			}
+
+
+		// Constructors
+		public:
+			EventLoop() = default;
+
+			EventLoop(const EventLoop&) = delete;
+			EventLoop& operator=(const EventLoop&) = delete;
+
+			~EventLoop() {
+				if (signal_fd != -1)
+					close(signal_fd);
+
+				if (epoll_fd != -1)
+					close(epoll_fd);
+			}
+
+
+		// Functions
+		public:
+			/*
+				Start watching the X connection `fd` and take over the
+				signals we handle. Returns false if any of the files could
+				not be created.
+			*/
+			bool open(const int fd) {
+				if (is_open())
+					return true;
+
+				const sigset_t set = handled_signals();
+
+				if (sigprocmask(SIG_BLOCK, &set, &original_mask) == -1)
+					return false;
+
+				masked = true;
+
+				epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+				signal_fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+
+				if (epoll_fd == -1 or signal_fd == -1 or pacer_timer.fd() == -1)
+					return false;
+
+				x_fd = fd;
+
+				// Children which exited before SIGCHLD was blocked, including
+				// ones launched by the process we were restarted from, would
+				// never be reaped otherwise.
+				fluke::children().reap();
+
+				return watch(x_fd) and watch(signal_fd) and watch(pacer_timer.fd());
+			}
+
+
+			bool is_open() const noexcept {
+				return epoll_fd != -1;
+			}
+
+
+			// Wake up when `fd` becomes readable.
+			bool watch(const int fd) {
+				epoll_event ev{};
+				ev.events = EPOLLIN;
+				ev.data.fd = fd;
+
+				return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+			}
+
+			void unwatch(const int fd) {
+				epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+			}
+
+
+			/*
+				Block until something is ready. Signals and our own timer are
+				handled here, `func(fd)` is called for every other watched
+				file which is ready.
+
+				Returns true if the X connection is readable. If waiting fails
+				for any reason other than a signal the loop is stopped.
+			*/
+			template <typename F>
+			bool wait(F&& func) {
+				std::array<epoll_event, 16> ready;
+
+				int count = -1;
+
+				do {
+					count = epoll_wait(epoll_fd, ready.data(), static_cast<int>(ready.size()), -1);
+				} while (count == -1 and errno == EINTR);
+
+				// Anything else won't go away by trying again, stop instead
+				// of spinning.
+				if (count == -1) {
+					tinge::errorln("cannot wait for events (", std::strerror(errno), ")!");
+					stop(EXIT_FAILURE);
+
+					return false;
+				}
+
+				bool x_ready = false;
+
+				for (int i = 0; i < count; ++i) {
+					const int fd = ready[static_cast<size_t>(i)].data.fd;
+
+					if (fd == x_fd)
+						x_ready = true;
+
+					else if (fd == signal_fd)
+						handle_signals();
+
+					else if (fd == pacer_timer.fd())
+						pacer_timer.consume();
+
+					else
+						func(fd);
+				}
+
+				// Errors on the X connection show up as readable, reading
+				// is how we find out about them.
+				return x_ready;
+			}
+
+
+			// Timer which wakes us up when the next paced ConfigureRequest is due.
+			fluke::Timer& pacer() noexcept {
+				return pacer_timer;
+			}
+
+
+			// Stop the event loop after the current batch.
+			void stop(const int status) noexcept {
+				stop_requested = true;
+				exit_status = status;
+			}
+
+			bool stopped() const noexcept {
+				return stop_requested;
+			}
+
+			int status() const noexcept {
+				return exit_status;
+			}
+
+
+			// The signal mask to hand to a program which replaces us, or
+			// nullptr if we never changed it.
+			const sigset_t* original_signal_mask() const noexcept {
+				return masked ? &original_mask : nullptr;
+			}
+
+
+			// True once after SIGUSR1 was received.
+			bool take_stats_request() noexcept {
+				return std::exchange(stats_requested, false);
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef FLUKE_IPC_HPP
+#define FLUKE_IPC_HPP
+
+#pragma once
+
+// This header is shared with `flukec` so it only depends on the standard
+// library and must not include anything from the rest of fluke.
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace fluke {
+	/*
+		Path of a per-display file in `$XDG_RUNTIME_DIR` (or `/tmp`).
+
+		example:
+			const auto path = fluke::runtime_path(".socket");  // "/run/user/1000/fluke:0.socket"
+	*/
+	inline std::string runtime_path(const char* suffix) {
+		const char* dir = std::getenv("XDG_RUNTIME_DIR");
+		const char* display = std::getenv("DISPLAY");
+
+		return std::string{dir ? dir : "/tmp"} + "/fluke" + (display ? display : "") + suffix;
+	}
+}
+
+
+namespace fluke::ipc {
+	/*
+		The protocol spoken over the control socket.
+
+		The socket is a `SOCK_SEQPACKET` Unix socket so every message arrives
+		whole. A client sends a fixed size `Request` naming a command and
+		up to `max_args` integer arguments, fluke answers every request with
+		a `ReplyHeader` followed by `count` records of the kind given in the
+		header. Requests are answered in order and a client may send as many
+		as it likes over one connection.
+
+		Commands are either actions from `config::commands` or queries which
+		are answered from what fluke already knows, neither involves a round
+		trip to X on our side unless the action itself needs one.
+
+		example:
+			auto request = fluke::ipc::make_request("workspace_change", 2);
+			send(fd, &request, sizeof(request), 0);
+	*/
+
+	constexpr uint32_t version = 1;
+
+	constexpr size_t max_name = 32;
+	constexpr size_t max_args = 4;
+
+	// Largest reply we will send, enough for thousands of windows.
+	constexpr size_t max_reply = 128 * 1024;
+
+	// Workspace of a window which doesn't belong to one.
+	constexpr uint32_t no_workspace = static_cast<uint32_t>(-1);
+
+
+	struct Request {
+		uint32_t version;
+		uint32_t argc;
+		int32_t args[max_args];
+		char name[max_name];  // Null terminated.
+	};
+
+
+	enum class Status: uint32_t {
+		ok,
+		bad_request,      // Malformed or from a different version.
+		unknown_command,
+		bad_arguments,    // Wrong number of arguments.
+	};
+
+	constexpr const char* STATUS_STRINGS[] = {
+		"ok",
+		"bad request",
+		"unknown command",
+		"bad arguments",
+	};
+
+
+	enum class Kind: uint32_t {
+		none,
+		windows,
+		displays,
+		commands,
+		children,
+	};
+
+
+	struct ReplyHeader {
+		uint32_t version;
+		Status status;
+		Kind kind;
+		uint32_t count;
+	};
+
+
+	// Every window in the window cache, bottom-most first.
+	struct WindowRecord {
+		uint32_t win;
+		int16_t x, y;
+		uint16_t w, h;
+
+		uint32_t crtc;       // Display of the workspace the window is on or 0.
+		uint32_t workspace;  // `no_workspace` if the window isn't on one.
+
+		uint8_t mapped;
+		uint8_t ignored;     // override_redirect
+		uint8_t hidden;      // On a workspace which isn't active.
+		uint8_t scratchpad;
+	};
+
+
+	struct DisplayRecord {
+		uint32_t crtc;
+		int16_t x, y;
+		uint16_t w, h;
+
+		uint64_t refresh;    // Nanoseconds between refreshes.
+		uint32_t workspace;  // Active workspace.
+		uint32_t tiled;      // Non-zero if BSP tiling is on.
+	};
+
+
+	// A command fluke knows about, see `config::commands`.
+	struct CommandRecord {
+		uint32_t argc;
+		char name[max_name];
+	};
+
+
+	// A program launched by fluke which is running or finished recently.
+	struct ChildRecord {
+		int32_t pid;
+		int32_t status;   // As returned by `waitpid`, only valid if not running.
+		uint32_t running;
+		char name[max_name];
+	};
+
+
+
+	/*
+		Build a request for `name` with integer arguments.
+
+		example:
+			const auto request = fluke::ipc::make_request("resize", 0, 0, 20, 20);
+	*/
+	template <typename... Ts>
+	inline Request make_request(const char* name, Ts... args) {
+		static_assert(sizeof...(Ts) <= max_args, "too many arguments!");
+
+		Request request{};
+
+		request.version = version;
+		request.argc = sizeof...(Ts);
+
+		size_t i = 0;
+		((request.args[i++] = static_cast<int32_t>(args)), ...);
+
+		std::strncpy(request.name, name, max_name - 1);
+
+		return request;
+	}
+
+
+
+	/*
+		A reply which is being built, records are appended after the header
+		as they are added.
+
+		example:
+			fluke::ipc::Reply reply;
+
+			reply.add(fluke::ipc::Kind::windows, record);
+			send(fd, reply.data(), reply.size(), 0);
+	*/
+	class Reply {
+		// Data
+		private:
+			std::vector<std::byte> buffer;
+
+
+		// Helpers
+		private:
+			ReplyHeader& header() noexcept {
+				return *reinterpret_cast<ReplyHeader*>(buffer.data());
+			}
+
+
+		// Constructors
+		public:
+			Reply():
+				buffer(sizeof(ReplyHeader))
+			{
+				header() = ReplyHeader{ version, Status::ok, Kind::none, 0 };
+			}
+
+
+		// Functions
+		public:
+			// Append a record, records which don't fit are dropped.
+			template <typename T>
+			void add(const Kind kind, const T& record) {
+				if (buffer.size() + sizeof(T) > max_reply)
+					return;
+
+				const auto bytes = reinterpret_cast<const std::byte*>(&record);
+				buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+
+				header().kind = kind;
+				header().count++;
+			}
+
+
+			void fail(const Status status) noexcept {
+				buffer.resize(sizeof(ReplyHeader));
+				header() = ReplyHeader{ version, status, Kind::none, 0 };
+			}
+
+
+			const std::byte* data() const noexcept {
+				return buffer.data();
+			}
+
+			size_t size() const noexcept {
+				return buffer.size();
+			}
+	};
+}
+
+#endif
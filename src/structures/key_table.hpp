@@ -0,0 +1,122 @@
+#ifndef FLUKE_KEY_TABLE_HPP
+#define FLUKE_KEY_TABLE_HPP
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	// A single passive key grab on the root window.
+	struct KeyGrab {
+		xcb_keycode_t keycode;
+		uint16_t mod;
+
+		constexpr bool operator==(const KeyGrab& rhs) const {
+			return keycode == rhs.keycode and mod == rhs.mod;
+		}
+
+		constexpr bool operator<(const KeyGrab& rhs) const {
+			return keycode < rhs.keycode or (keycode == rhs.keycode and mod < rhs.mod);
+		}
+	};
+
+
+
+	/*
+		A dense lookup table which maps a keycode and modifier mask to the
+		index of a keybinding.
+
+		The table is filled when keybindings are registered so that a keypress
+		can be matched without translating the keycode to a keysym or
+		scanning every keybinding.
+
+		We also remember which key grabs are currently active so that we
+		only need to grab and ungrab the difference when the keyboard
+		mapping changes.
+
+		Lock modifiers (caps lock, num lock and scroll lock) are ignored, the
+		five remaining modifiers are packed into 5 bits which gives us
+		256 keycodes * 32 modifier combinations.
+
+		example:
+			if (const auto i = conn.keytable().find(e->detail, e->state); i != fluke::KeyTable::none)
+				fluke::config::keybindings[i].func(conn);
+	*/
+	class KeyTable {
+		// Types
+		public:
+			using index_type = uint16_t;
+
+			static constexpr index_type none = static_cast<index_type>(-1);
+
+
+		// Data
+		private:
+			static constexpr size_t keycodes = 256;
+			static constexpr size_t modifiers = 32;
+
+			std::array<index_type, keycodes * modifiers> table;
+
+			// Sorted set of active grabs.
+			std::vector<fluke::KeyGrab> active_grabs;
+
+
+		// Helpers
+		private:
+			// Pack the modifiers we care about into the low 5 bits.
+			static constexpr size_t pack(const unsigned mask) {
+				return
+					((mask & XCB_MOD_MASK_SHIFT))        |
+					((mask & XCB_MOD_MASK_CONTROL) >> 1) |
+					((mask & XCB_MOD_MASK_1)       >> 1) |
+					((mask & XCB_MOD_MASK_3)       >> 2) |
+					((mask & XCB_MOD_MASK_4)       >> 2)
+				;
+			}
+
+			static constexpr size_t slot(const xcb_keycode_t keycode, const unsigned mask) {
+				return size_t{keycode} * modifiers + pack(mask);
+			}
+
+
+		// Constructor
+		public:
+			KeyTable() {
+				clear();
+			}
+
+
+		// Functions
+		public:
+			void clear() noexcept {
+				table.fill(none);
+			}
+
+
+			// Associate a keycode and modifier mask with a keybinding.
+			// The first keybinding to claim a slot keeps it.
+			void insert(const xcb_keycode_t keycode, const unsigned mask, const size_t index) noexcept {
+				auto& entry = table[slot(keycode, mask)];
+
+				if (entry == none)
+					entry = static_cast<index_type>(index);
+			}
+
+
+			// Returns the index of the matching keybinding or `none`.
+			index_type find(const xcb_keycode_t keycode, const unsigned mask) const noexcept {
+				return table[slot(keycode, mask)];
+			}
+
+
+			std::vector<fluke::KeyGrab>& grabs() noexcept {
+				return active_grabs;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef FLUKE_MOTION_TRACKER_HPP
+#define FLUKE_MOTION_TRACKER_HPP
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Keeps track of the newest pointer position and of pointer motion
+		hints, see `MOTION_HINTS` in `config/options.hpp`.
+
+		When motion is selected with `XCB_EVENT_MASK_POINTER_MOTION_HINT`,
+		X sends a single MotionNotify and then nothing until we query the
+		pointer. The query re-arms the hint and its reply tells us where
+		the pointer is now. We make at most one query per batch and per
+		refresh of the display under the pointer, so a 1000Hz mouse costs
+		one event and one reply per frame rather than a thousand events
+		per second. The reply is collected whenever it arrives, nothing
+		ever waits for it.
+
+		example:
+			auto& motion = conn.motion();
+
+			if (motion.due(now))
+				motion.queried(fluke::query_pointer(conn, conn.root()).cookie.sequence, now, interval);
+	*/
+	class MotionTracker {
+		// Types
+		public:
+			using clock = std::chrono::steady_clock;
+
+
+		// Data
+		private:
+			fluke::Point newest;
+
+			bool hinted = false;     // X sends no more motion until we query the pointer.
+			bool in_flight = false;  // A query has been sent and its reply hasn't been collected.
+			unsigned int query_sequence = 0;
+
+			clock::time_point next = clock::time_point::min();  // Earliest time we may query again.
+
+
+		// Functions
+		public:
+			// The newest pointer position we know of, in root coordinates.
+			const fluke::Point& position() const noexcept {
+				return newest;
+			}
+
+			// Record a position, returns true if the pointer moved.
+			bool moved(const fluke::Point& p) noexcept {
+				const bool changed = p.x != newest.x or p.y != newest.y;
+				newest = p;
+
+				return changed;
+			}
+
+			// A hint arrived, the pointer has to be queried to get the next one.
+			void hint(const fluke::Point& p) noexcept {
+				moved(p);
+				hinted = true;
+			}
+
+
+			// True if a hint is waiting to be re-armed, the query may not be due yet.
+			bool pending() const noexcept {
+				return hinted and not in_flight;
+			}
+
+			bool due(const clock::time_point now) const noexcept {
+				return pending() and now >= next;
+			}
+
+			clock::time_point deadline() const noexcept {
+				return next;
+			}
+
+
+			// A query was sent, no other query is made before `now + interval`.
+			void queried(const unsigned int sequence, const clock::time_point now, const clock::duration interval) noexcept {
+				hinted = false;
+				in_flight = true;
+				query_sequence = sequence;
+				next = now + interval;
+			}
+
+			// True while we are waiting on the reply to `sequence()`.
+			bool awaiting() const noexcept {
+				return in_flight;
+			}
+
+			unsigned int sequence() const noexcept {
+				return query_sequence;
+			}
+
+			void answered() noexcept {
+				in_flight = false;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef FLUKE_PROFILE_HPP
+#define FLUKE_PROFILE_HPP
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include <cstdlib>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Statistics for a single request type.
+
+		`stalls` counts the replies which had not arrived yet when we asked
+		for them, each of these is a blocking round trip. `histogram` holds
+		the time spent blocked where bucket `i` counts waits of roughly
+		2^(i-1) microseconds, bucket 0 counts waits under a microsecond.
+	*/
+	struct RequestProfile {
+		static constexpr size_t buckets = 16;
+
+		size_t issued = 0;
+		size_t replies = 0;
+		size_t stalls = 0;
+
+		uint64_t total_ns = 0;
+		uint64_t max_ns = 0;
+
+		std::array<size_t, buckets> histogram{};
+	};
+
+
+
+	/*
+		Records how many requests of each type are sent and how long we spend
+		blocked on their replies.
+
+		Requests are attributed to the action or event handler which was running
+		when they were made, see `fluke::ProfileScope`. This lets us find out which
+		keybinding is slow on a loaded X server.
+
+		The profiler is updated from `fluke::get` and the cookie constructors
+		which don't have access to a connection so it lives outside of
+		`fluke::Connection`.
+
+		Profiling can be disabled with `fluke::config::PROFILE_REQUESTS`.
+
+		example:
+			fluke::print_request_stats();
+	*/
+	class Profiler {
+		// Types
+		public:
+			// (context, request)
+			using key_type = std::pair<const char*, const char*>;
+
+
+		// Data
+		private:
+			const char* current = "startup";
+			std::map<key_type, fluke::RequestProfile> table;
+
+
+		// Functions
+		public:
+			const char* context() const noexcept {
+				return current;
+			}
+
+			void set_context(const char* ctx) noexcept {
+				current = ctx;
+			}
+
+
+			void issued(const char* request) {
+				table[{current, request}].issued++;
+			}
+
+
+			void replied(const char* request, const uint64_t ns, const bool stalled) {
+				auto& entry = table[{current, request}];
+
+				entry.replies++;
+
+				if (not stalled)
+					return;
+
+				entry.stalls++;
+				entry.total_ns += ns;
+				entry.max_ns = std::max(entry.max_ns, ns);
+
+				// Bucket index is the number of bits needed to represent the wait in microseconds.
+				size_t bucket = 0;
+				for (uint64_t us = ns / 1000; us != 0 and bucket < RequestProfile::buckets - 1; us >>= 1)
+					bucket++;
+
+				entry.histogram[bucket]++;
+			}
+
+
+			void clear() noexcept {
+				table.clear();
+			}
+
+
+		// Iterators
+		public:
+			auto begin() const noexcept { return table.begin(); }
+			auto end() const noexcept { return table.end(); }
+	};
+
+
+
+	inline fluke::Profiler profiler;
+
+
+
+	/*
+		Attribute all requests made during the lifetime of this object
+		to `ctx`. Scopes can be nested, the previous context is restored
+		on destruction.
+
+		example:
+			{
+				fluke::ProfileScope scope{"action_focus"};
+				fluke::action_focus(conn, FOCUS_NEXT);
+			}
+	*/
+	class ProfileScope {
+		private:
+			const char* previous;
+
+		public:
+			explicit ProfileScope(const char* ctx) noexcept:
+				previous(fluke::profiler.context())
+			{
+				fluke::profiler.set_context(ctx);
+			}
+
+			~ProfileScope() {
+				fluke::profiler.set_context(previous);
+			}
+
+			ProfileScope(const ProfileScope&) = delete;
+			ProfileScope& operator=(const ProfileScope&) = delete;
+	};
+
+
+
+	namespace detail {
+		// Called by cookie constructors.
+		inline void profile_issue(const char* request) {
+			if constexpr(fluke::config::PROFILE_REQUESTS)
+				fluke::profiler.issued(request);
+		}
+
+
+		// Fetch a reply and record whether or not we had to wait for it.
+		template <typename T, typename F>
+		inline T* profile_reply(xcb_connection_t* conn, const char* request, const unsigned sequence, F&& func) {
+			if constexpr(not fluke::config::PROFILE_REQUESTS) {
+				return func();
+			}
+
+			else {
+				// If the reply has already arrived then we don't need to block.
+				void* reply = nullptr;
+				xcb_generic_error_t* error = nullptr;
+
+				if (xcb_poll_for_reply(conn, sequence, &reply, &error)) {
+					std::free(error);
+					fluke::profiler.replied(request, 0, false);
+					return static_cast<T*>(reply);
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				T* ret = func();
+				const auto end = std::chrono::steady_clock::now();
+
+				fluke::profiler.replied(
+					request,
+					static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()),
+					true
+				);
+
+				return ret;
+			}
+		}
+	}
+
+
+
+	/*
+		Print the request statistics of every context.
+
+		example:
+			fluke::print_request_stats();
+	*/
+	inline void print_request_stats() {
+		const char* ctx = nullptr;
+
+		tinge::noticeln("request statistics:");
+
+		for (const auto& [key, entry]: fluke::profiler) {
+			const auto& [context, request] = key;
+
+			if (context != ctx) {
+				ctx = context;
+				tinge::noticeln(tinge::before{'\t'}, "context '", tinge::fg::make_yellow(context), "'");
+			}
+
+			// Only print buckets which have samples.
+			std::string histogram;
+			for (size_t i = 0; i < entry.histogram.size(); ++i) {
+				if (entry.histogram[i] != 0)
+					histogram += tinge::strcat(" ", i == 0 ? 0 : 1u << (i - 1), "us:", entry.histogram[i]);
+			}
+
+			tinge::noticeln(
+				tinge::before{'\t'}, '\t', request,
+				" issued(", entry.issued,
+				") replies(", entry.replies,
+				") stalls(", entry.stalls,
+				") blocked(", entry.total_ns / 1000, "us total, ",
+				entry.max_ns / 1000, "us max)", histogram
+			);
+		}
+	}
+}
+
+#endif
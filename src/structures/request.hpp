@@ -49,6 +49,11 @@ namespace fluke {
 		This macro is used to define a cookie structure, unique_ptr alias
 		and overloaded get function.
 
+		Creating a cookie and calling `get` on it are recorded by
+		`fluke::profiler` since this is where we block on the server.
+		Replies also pass through `fluke::Trace` so that they can be
+		recorded and replayed.
+
 		GET_REQUEST(InternAtom, intern_atom) defines the following:
 			struct InternAtomCookie { ... };
 			using InternAtomReply = ... ;
@@ -56,12 +61,20 @@ namespace fluke {
 	*/
 	#define NEW_REQUEST(name, type) \
 		struct name##Cookie: Cookie<xcb_##type##_cookie_t> { \
-			template <typename... Ts> constexpr name##Cookie(cookie_t cookie_): \
-				Cookie::Cookie{cookie_} {} \
+			static constexpr const char* request_name = #name; \
+			template <typename... Ts> name##Cookie(cookie_t cookie_): \
+				Cookie::Cookie{cookie_} { fluke::detail::profile_issue(request_name); } \
 		}; \
 		using name##Reply = std::unique_ptr<xcb_##type##_reply_t, decltype(&std::free)>; \
 		inline auto get(fluke::Connection& conn, const name##Cookie& cookie) { \
-			return name##Reply{xcb_##type##_reply(conn, cookie, nullptr), std::free}; \
+			return name##Reply{fluke::detail::trace_reply<xcb_##type##_reply_t>( \
+				conn, conn.trace(), cookie.cookie.sequence, [&] { \
+					return fluke::detail::profile_reply<xcb_##type##_reply_t>( \
+						conn, name##Cookie::request_name, cookie.cookie.sequence, \
+						[&] { return xcb_##type##_reply(conn, cookie, nullptr); } \
+					); \
+				} \
+			), std::free}; \
 		}
 
 
@@ -80,6 +93,7 @@ namespace fluke {
 	NEW_REQUEST(RandrGetOutputPrimary,          randr_get_output_primary)
 	NEW_REQUEST(RandrGetScreenResourcesCurrent, randr_get_screen_resources_current)
 	NEW_REQUEST(GrabPointer,                    grab_pointer)
+	NEW_REQUEST(GetKeyboardMapping,             get_keyboard_mapping)
 
 
 	#undef NEW_REQUEST
@@ -180,6 +194,13 @@ namespace fluke {
 	}
 
 
+	inline GetKeyboardMappingCookie get_keyboard_mapping(
+		fluke::Connection& conn, const xcb_keycode_t first_keycode, const uint8_t count
+	) {
+		return xcb_get_keyboard_mapping_unchecked(conn, first_keycode, count);
+	}
+
+
 
 
 
@@ -246,6 +267,41 @@ namespace fluke {
 
 
 
+	/*
+		Wait for a checked request to complete and return the error it
+		generated, if any.
+
+		Only the first check after a series of requests blocks, X handles
+		requests in order so once one has completed, all earlier requests
+		have completed too.
+
+		example:
+			if (auto err = fluke::request_check(conn, cookie))
+				std::cout << int(err->error_code) << '\n';
+	*/
+	inline auto request_check(fluke::Connection& conn, const xcb_void_cookie_t cookie) {
+		using Error = std::unique_ptr<xcb_generic_error_t, decltype(&std::free)>;
+
+		auto& trace = conn.trace();
+
+		if (trace.replaying()) {
+			xcb_discard_reply(conn, cookie.sequence);
+			return Error{trace.next_check(), std::free};
+		}
+
+		auto err = Error{xcb_request_check(conn, cookie), std::free};
+		trace.write(fluke::Trace::Kind::check, err.get(), err ? sizeof(xcb_generic_error_t) : 0);
+
+		return err;
+	}
+
+
+
+
+
+
+
+
 	// Setter functions
 	template <typename T, typename... Ts>
 	inline void configure_window(
@@ -306,6 +362,27 @@ namespace fluke {
 
 
 
+	inline void change_save_set(fluke::Connection& conn, const uint8_t mode, const xcb_window_t win) {
+		xcb_change_save_set(conn, mode, win);
+	}
+
+
+
+	inline void change_property(
+		fluke::Connection& conn,
+		const uint8_t mode,
+		const xcb_window_t win,
+		const xcb_atom_t property,
+		const xcb_atom_t type,
+		const uint8_t format,
+		const uint32_t length,
+		const void* data
+	) {
+		xcb_change_property(conn, mode, win, property, type, format, length, data);
+	}
+
+
+
 	inline void warp_pointer(
 		fluke::Connection& conn,
 		const xcb_window_t src, const xcb_window_t dest,
@@ -332,11 +409,50 @@ namespace fluke {
 
 
 
+	// Same as `grab_key` but errors are kept for `fluke::request_check` instead
+	// of being sent to the event loop.
+	inline xcb_void_cookie_t grab_key_checked(
+		fluke::Connection& conn,
+		const bool owner_events,
+		const xcb_window_t grab_window,
+		const uint16_t modifiers,
+		const xcb_keycode_t key,
+		const uint8_t pointer_mode,
+		const uint8_t keyboard_mode
+	) {
+		return xcb_grab_key_checked(conn, owner_events, grab_window, modifiers, key, pointer_mode, keyboard_mode);
+	}
+
+
+
 	inline void ungrab_key(fluke::Connection& conn, const xcb_keycode_t key, const xcb_window_t grab_window, const uint16_t modifiers) {
 		xcb_ungrab_key(conn, key, grab_window, modifiers);
 	}
 
 
+
+	inline void grab_button(
+		fluke::Connection& conn,
+		const bool owner_events,
+		const xcb_window_t grab_window,
+		const uint16_t event_mask,
+		const uint8_t pointer_mode,
+		const uint8_t keyboard_mode,
+		const xcb_window_t confine_to,
+		const xcb_cursor_t cursor,
+		const uint8_t button,
+		const uint16_t modifiers
+	) {
+		xcb_grab_button(conn, owner_events, grab_window, event_mask, pointer_mode, keyboard_mode, confine_to, cursor, button, modifiers);
+	}
+
+
+
+	inline void ungrab_button(fluke::Connection& conn, const uint8_t button, const xcb_window_t grab_window, const uint16_t modifiers) {
+		xcb_ungrab_button(conn, button, grab_window, modifiers);
+	}
+
+
 	template <typename T>
 	inline void send_event(fluke::Connection& conn, const bool propagate, const xcb_window_t win, const uint32_t event_mask, const T event) {
 		xcb_send_event(conn, propagate, win, event_mask, reinterpret_cast<const char*>(event));
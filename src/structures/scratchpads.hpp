@@ -0,0 +1,159 @@
+#ifndef FLUKE_SCRATCHPADS_HPP
+#define FLUKE_SCRATCHPADS_HPP
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <sys/types.h>
+}
+
+
+namespace fluke {
+	/*
+		A program which is started hidden and shown on demand, see
+		`config/scratchpads.hpp`.
+
+		The window is recognised by the instance name in its WM_CLASS so the
+		command should set it, most terminals take `-n` or `--name`. The
+		command must not fork into the background, once it exits we stop
+		waiting for its window.
+	*/
+	struct ScratchpadConfig {
+		const char* instance;
+		std::array<const char*, 8> command;  // argv, unused slots are nullptr.
+
+		// Size as a percentage of the display, the window is centered.
+		int width_percent;
+		int height_percent;
+	};
+
+
+
+	/*
+		Runtime state of the scratchpads, indexed the same as
+		`config::scratchpads`.
+
+		Every scratchpad is launched once, its window is claimed when it
+		first asks to be mapped and is then kept unmapped until it is shown.
+		The geometry is worked out when the window is claimed and reused for
+		every toggle so showing a scratchpad is only a map, a restack and a
+		focus request.
+
+		example:
+			auto& pads = conn.scratchpads();
+
+			if (const auto i = pads.find(win); i != fluke::Scratchpads::npos)
+				std::cout << pads[i].rect << '\n';
+	*/
+	class Scratchpads {
+		// Types
+		public:
+			static constexpr size_t npos = static_cast<size_t>(-1);
+
+			struct Slot {
+				xcb_window_t win = XCB_NONE;
+				fluke::Rect rect;
+
+				bool launched = false;  // Started but its window hasn't been claimed yet.
+				bool visible = false;
+				bool show_on_claim = false;
+
+				pid_t pid = -1;  // Program we are waiting on while `launched`.
+			};
+
+
+		// Data
+		private:
+			std::vector<Slot> slots;
+
+			// Number of slots which are waiting for their window to be mapped.
+			size_t waiting = 0;
+
+
+		// Constructors
+		public:
+			explicit Scratchpads(const size_t count):
+				slots(count)
+			{
+
+			}
+
+
+		// Functions
+		public:
+
+			auto size() const noexcept {
+				return slots.size();
+			}
+
+			Slot& operator[](const size_t i) {
+				return slots[i];
+			}
+
+			const Slot& operator[](const size_t i) const {
+				return slots[i];
+			}
+
+
+			// Index of the scratchpad which owns `win` or `npos`.
+			size_t find(const xcb_window_t win) const {
+				if (win == XCB_NONE)
+					return npos;
+
+				for (size_t i = 0; i < slots.size(); ++i) {
+					if (slots[i].win == win)
+						return i;
+				}
+
+				return npos;
+			}
+
+
+			void launched(const size_t i, const pid_t pid) {
+				if (slots[i].launched)
+					return;
+
+				slots[i].launched = true;
+				slots[i].pid = pid;
+				waiting++;
+			}
+
+			// True while there are scratchpads whose window we still have to find,
+			// we only need to look at the WM_CLASS of new windows until then.
+			bool waiting_for_windows() const noexcept {
+				return waiting != 0;
+			}
+
+
+			void claim(const size_t i, const xcb_window_t win, const fluke::Rect& rect) {
+				auto& slot = slots[i];
+
+				if (slot.launched)
+					waiting--;
+
+				slot.win = win;
+				slot.rect = rect;
+				slot.launched = false;
+				slot.pid = -1;
+				slot.visible = false;
+			}
+
+
+			// The window of scratchpad `i` is gone, it will be launched again
+			// the next time it is shown.
+			void release(const size_t i) {
+				auto& slot = slots[i];
+
+				if (slot.launched)
+					waiting--;
+
+				slot = Slot{};
+			}
+	};
+}
+
+#endif
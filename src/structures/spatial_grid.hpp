@@ -0,0 +1,251 @@
+#ifndef FLUKE_SPATIAL_GRID_HPP
+#define FLUKE_SPATIAL_GRID_HPP
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstdlib>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		A uniform grid over the screen which indexes windows by the center
+		of their rect.
+
+		Each cell holds the windows whose center falls inside of it. A query
+		looks at the cell containing the query point first and then at rings
+		of cells further and further away, it stops as soon as no window in
+		the next ring could be closer than the best one found so far. With
+		windows spread over the screen only a handful of cells are visited
+		no matter how many windows there are.
+
+		Points outside of the bounds are clamped to the cells on the edge,
+		this keeps every query correct if the screen grows and the grid
+		hasn't been resized yet, it is just slower.
+
+		Queries don't allocate, updates only allocate when a cell outgrows
+		its capacity.
+
+		example:
+			fluke::SpatialGrid grid{fluke::Rect{ 0, 0, 1920, 1080 }};
+
+			grid.insert(win, rect);
+
+			const xcb_window_t nearest = grid.nearest(point, [] (xcb_window_t, fluke::Point) {
+				return true;
+			});
+	*/
+	class SpatialGrid {
+		// Constants
+		public:
+			static constexpr int cols = 16;
+			static constexpr int rows = 16;
+
+
+		// Types
+		private:
+			struct Entry {
+				xcb_window_t win;
+				fluke::Point center;
+			};
+
+
+		// Data
+		private:
+			fluke::Rect bounds;
+
+			int cell_w = 1;
+			int cell_h = 1;
+
+			std::array<std::vector<Entry>, cols * rows> cells;
+
+			// Cell which each window is in.
+			std::unordered_map<xcb_window_t, int> locations;
+
+
+		// Helpers
+		private:
+			static fluke::Point center(const fluke::Rect& r) noexcept {
+				return fluke::Point{ r.x + r.w / 2, r.y + r.h / 2 };
+			}
+
+
+			int column(const int x) const noexcept {
+				return std::clamp((x - bounds.x) / cell_w, 0, cols - 1);
+			}
+
+			int row(const int y) const noexcept {
+				return std::clamp((y - bounds.y) / cell_h, 0, rows - 1);
+			}
+
+			int cell_of(const fluke::Point& p) const noexcept {
+				return row(p.y) * cols + column(p.x);
+			}
+
+
+			void remove_from(const int cell, const xcb_window_t win) {
+				auto& entries = cells[static_cast<size_t>(cell)];
+
+				for (auto& entry: entries) {
+					if (entry.win == win) {
+						entry = entries.back();
+						entries.pop_back();
+						return;
+					}
+				}
+			}
+
+
+		// Constructors
+		public:
+			SpatialGrid() = default;
+
+			explicit SpatialGrid(const fluke::Rect& bounds_) {
+				resize(bounds_);
+			}
+
+
+		// Functions
+		public:
+			// Change the area covered by the grid, every window is re-indexed.
+			void resize(const fluke::Rect& bounds_) {
+				bounds = bounds_;
+
+				cell_w = std::max(1, (bounds.w + cols - 1) / cols);
+				cell_h = std::max(1, (bounds.h + rows - 1) / rows);
+
+				std::vector<Entry> all;
+				all.reserve(locations.size());
+
+				for (auto& entries: cells) {
+					all.insert(all.end(), entries.begin(), entries.end());
+					entries.clear();
+				}
+
+				for (const auto& entry: all) {
+					const int cell = cell_of(entry.center);
+
+					cells[static_cast<size_t>(cell)].emplace_back(entry);
+					locations[entry.win] = cell;
+				}
+			}
+
+
+			// Add `win` or move it if it is already in the grid.
+			void insert(const xcb_window_t win, const fluke::Rect& rect) {
+				const auto point = center(rect);
+				const int cell = cell_of(point);
+
+				if (const auto it = locations.find(win); it != locations.end()) {
+					// Still in the same cell, just update the center.
+					if (it->second == cell) {
+						for (auto& entry: cells[static_cast<size_t>(cell)]) {
+							if (entry.win == win)
+								entry.center = point;
+						}
+
+						return;
+					}
+
+					remove_from(it->second, win);
+					it->second = cell;
+				}
+
+				else {
+					locations.emplace(win, cell);
+				}
+
+				cells[static_cast<size_t>(cell)].emplace_back(Entry{ win, point });
+			}
+
+
+			void erase(const xcb_window_t win) {
+				const auto it = locations.find(win);
+
+				if (it == locations.end())
+					return;
+
+				remove_from(it->second, win);
+				locations.erase(it);
+			}
+
+
+			void clear() noexcept {
+				for (auto& entries: cells)
+					entries.clear();
+
+				locations.clear();
+			}
+
+
+			bool contains(const xcb_window_t win) const {
+				return locations.find(win) != locations.end();
+			}
+
+			auto size() const noexcept {
+				return locations.size();
+			}
+
+
+			/*
+				Find the window whose center is nearest to `p`, measured the
+				same way as `fluke::distance_abs`. Only windows for which
+				`accept(win, center)` returns true are considered.
+
+				Returns `XCB_NONE` if there are no such windows.
+			*/
+			template <typename F>
+			xcb_window_t nearest(const fluke::Point& p, F&& accept) const {
+				const int px = column(p.x);
+				const int py = row(p.y);
+
+				xcb_window_t best = XCB_NONE;
+				int best_dist = std::numeric_limits<int>::max();
+
+				const auto visit = [&] (const int cx, const int cy) {
+					for (const auto& [win, point]: cells[static_cast<size_t>(cy * cols + cx)]) {
+						const int dist = std::abs(point.x - p.x) + std::abs(point.y - p.y);
+
+						if (dist < best_dist and accept(win, point)) {
+							best = win;
+							best_dist = dist;
+						}
+					}
+				};
+
+				const int max_ring = std::max({ px, py, cols - 1 - px, rows - 1 - py });
+
+				for (int ring = 0; ring <= max_ring; ++ring) {
+					// Every point in this ring is at least this far from `p`.
+					const int ring_dist = (ring - 1) * std::min(cell_w, cell_h);
+
+					if (best != XCB_NONE and best_dist <= ring_dist)
+						break;
+
+					// Walk the cells on the border of the square around `p`.
+					for (int cy = py - ring; cy <= py + ring; ++cy) {
+						if (cy < 0 or cy >= rows)
+							continue;
+
+						const bool edge = cy == py - ring or cy == py + ring;
+						const int step = edge ? 1 : std::max(1, 2 * ring);
+
+						for (int cx = px - ring; cx <= px + ring; cx += step) {
+							if (cx >= 0 and cx < cols)
+								visit(cx, cy);
+						}
+					}
+				}
+
+				return best;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef FLUKE_STATS_HPP
+#define FLUKE_STATS_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Counters which are updated by the main event loop, these are
+		useful for finding out how much work the window manager is doing.
+
+		example:
+			std::cout << conn.stats().events_received << '\n';
+	*/
+	struct Stats {
+		// Every event we have taken off of the queue.
+		size_t events_received = 0;
+
+		// Events which made it to an `event_*` handler after coalescing.
+		size_t events_dispatched = 0;
+
+		// Events which were merged into a newer event of the same kind.
+		size_t configure_requests_folded = 0;
+		size_t motion_notifies_folded = 0;
+
+		// ConfigureRequests which were held back to the display refresh rate.
+		size_t configure_requests_paced = 0;
+
+		// Pointer queries made to re-arm motion hints.
+		size_t motion_queries = 0;
+
+		// Number of batches handled by the main loop and the size of the largest one.
+		size_t batches = 0;
+		size_t largest_batch = 0;
+
+		// Number of times the main loop flushed requests before blocking.
+		size_t flushes = 0;
+
+		// Requests answered on the control socket.
+		size_t ipc_requests = 0;
+	};
+}
+
+#endif
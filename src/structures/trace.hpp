@@ -0,0 +1,500 @@
+#ifndef FLUKE_TRACE_HPP
+#define FLUKE_TRACE_HPP
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/socket.h>
+	#include <sys/wait.h>
+}
+
+
+namespace fluke {
+	namespace detail {
+		// Set while a trace is being replayed so that `fluke::exec` doesn't
+		// launch programs from hooks and keybindings.
+		inline bool replay_active = false;
+
+
+		// Deleter for memory mapped files.
+		struct Unmap {
+			size_t size = 0;
+
+			void operator()(std::byte* ptr) const noexcept {
+				munmap(ptr, size);
+			}
+		};
+	}
+
+
+
+	/*
+		A binary trace of everything the window manager received from X.
+
+		When recording, every event taken off of the queue, every reply
+		consumed by `fluke::get` and every result of `fluke::request_check`
+		is appended to a file along with a monotonic timestamp. The start of
+		each event batch is marked so that batches are replayed exactly as
+		they were received. Replies to the pointer queries made for motion
+		hints are picked up whenever they happen to arrive, they are
+		recorded as their own kind of record at the point they were handled.
+
+		When replaying, the trace is mapped into memory and the records are
+		handed back in the same order. The event loop reads events from the
+		trace instead of X and `fluke::get` returns the recorded replies, so
+		the same `event_*` handlers run against a stand-in connection (see
+		`fluke::replay_connection`) which never answers.
+
+		Layout:
+			Header
+			xcb_setup_t                       (header.setup_length bytes)
+			xcb_query_extension_reply_t       (randr)
+			xcb_get_keyboard_mapping_reply_t  (header.keymap_length bytes)
+			Record, payload, padding          (repeated until end of file)
+
+		example:
+			conn.trace().record("session.trace", xcb_get_setup(conn), randr_ext, keymap.get());
+	*/
+	class Trace {
+		// Types
+		public:
+			enum class Kind: uint8_t {
+				batch, event, reply, check, motion,
+			};
+
+			struct Header {
+				char magic[4];
+				uint32_t version;
+				uint32_t setup_length;
+				uint32_t keymap_length;
+			};
+
+			struct Record {
+				Kind kind;
+				uint8_t pad[3];
+				uint32_t length;      // Length of the payload in bytes, 0 for a missing reply.
+				uint64_t timestamp;   // Nanoseconds since recording started.
+			};
+
+			static constexpr char magic[4] = {'F', 'L', 'K', 'T'};
+			static constexpr uint32_t version = 3;
+
+
+		private:
+			// Records are aligned to 8 bytes so that they can be read in place.
+			static constexpr size_t align(const size_t n) noexcept {
+				return (n + 7) & ~size_t{7};
+			}
+
+
+		// Data
+		private:
+			enum class Mode {
+				off, record, replay,
+			} mode = Mode::off;
+
+			// Recording.
+			std::unique_ptr<std::FILE, decltype(&std::fclose)> file{nullptr, &std::fclose};
+			std::chrono::steady_clock::time_point start;
+
+			// Replaying.
+			std::unique_ptr<std::byte, detail::Unmap> mapping;
+			size_t offset = 0;
+			size_t records = 0;
+			uint64_t last_timestamp = 0;
+			bool desynced = false;
+
+
+		// Helpers
+		private:
+			uint64_t elapsed() const noexcept {
+				return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start
+				).count());
+			}
+
+
+			void write_padded(const void* data, const size_t length) {
+				static constexpr std::byte zeroes[8]{};
+
+				std::fwrite(data, 1, length, file.get());
+				std::fwrite(zeroes, 1, align(length) - length, file.get());
+			}
+
+
+			const std::byte* data() const noexcept {
+				return mapping.get();
+			}
+
+			size_t size() const noexcept {
+				return mapping.get_deleter().size;
+			}
+
+			const Header* header() const noexcept {
+				return reinterpret_cast<const Header*>(data());
+			}
+
+
+			// Next record or nullptr at the end of the trace.
+			const Record* peek() const noexcept {
+				if (desynced or offset + sizeof(Record) > size())
+					return nullptr;
+
+				const auto record = reinterpret_cast<const Record*>(data() + offset);
+
+				if (offset + sizeof(Record) + record->length > size())
+					return nullptr;
+
+				return record;
+			}
+
+
+			// Take the next record which must be of kind `kind` and return
+			// a malloc'd copy of its payload.
+			void* take(const Kind kind) {
+				const auto record = peek();
+
+				if (not record)
+					return nullptr;
+
+				if (record->kind != kind) {
+					tinge::errorln(
+						"trace out of sync at record ", records, ", expected kind ",
+						static_cast<int>(kind), " but found ", static_cast<int>(record->kind), "!"
+					);
+
+					desynced = true;
+					return nullptr;
+				}
+
+				const auto payload = data() + offset + sizeof(Record);
+
+				offset += sizeof(Record) + align(record->length);
+				records++;
+				last_timestamp = record->timestamp;
+
+				if (record->length == 0)
+					return nullptr;
+
+				void* copy = std::malloc(record->length);
+				std::memcpy(copy, payload, record->length);
+
+				return copy;
+			}
+
+
+		// Functions
+		public:
+			bool recording() const noexcept {
+				return mode == Mode::record;
+			}
+
+			bool replaying() const noexcept {
+				return mode == Mode::replay;
+			}
+
+
+			/*
+				Start recording to `path`. The setup, randr extension data and
+				keyboard mapping are written first so that a stand-in connection
+				can be built on replay.
+			*/
+			bool record(
+				const char* path,
+				const xcb_setup_t* setup,
+				const xcb_query_extension_reply_t* randr,
+				const xcb_get_keyboard_mapping_reply_t* keymap
+			) {
+				if (not keymap)
+					return false;
+
+				// Close on exec so that programs we launch don't inherit the trace.
+				file.reset(std::fopen(path, "wbe"));
+
+				if (not file)
+					return false;
+
+				const Header hdr{
+					{magic[0], magic[1], magic[2], magic[3]},
+					version,
+					static_cast<uint32_t>(xcb_setup_sizeof(setup)),
+					static_cast<uint32_t>(sizeof(xcb_get_keyboard_mapping_reply_t) + keymap->length * 4)
+				};
+
+				std::fwrite(&hdr, sizeof(Header), 1, file.get());
+				write_padded(setup, hdr.setup_length);
+				write_padded(randr, sizeof(xcb_query_extension_reply_t));
+				write_padded(keymap, hdr.keymap_length);
+
+				mode = Mode::record;
+				start = std::chrono::steady_clock::now();
+
+				return true;
+			}
+
+
+			/*
+				Map a trace at `path` into memory for replaying.
+			*/
+			bool replay(const char* path) {
+				const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+				if (fd == -1)
+					return false;
+
+				struct stat st;
+				void* ptr = MAP_FAILED;
+
+				if (fstat(fd, &st) == 0 and st.st_size > 0)
+					ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+				close(fd);
+
+				if (ptr == MAP_FAILED)
+					return false;
+
+				mapping = std::unique_ptr<std::byte, detail::Unmap>{
+					static_cast<std::byte*>(ptr), detail::Unmap{static_cast<size_t>(st.st_size)}
+				};
+
+				// Check the header and skip over the setup, extension data and keyboard mapping.
+				if (
+					size() < sizeof(Header) or
+					std::memcmp(header()->magic, magic, sizeof(magic)) != 0 or
+					header()->version != version or
+					header()->keymap_length < sizeof(xcb_get_keyboard_mapping_reply_t)
+				)
+					return false;
+
+				offset =
+					sizeof(Header) +
+					align(header()->setup_length) +
+					align(sizeof(xcb_query_extension_reply_t)) +
+					align(header()->keymap_length)
+				;
+
+				if (offset > size())
+					return false;
+
+				mode = Mode::replay;
+				detail::replay_active = true;
+
+				return true;
+			}
+
+
+			// Recorded setup and randr extension data.
+			const std::byte* setup() const noexcept {
+				return data() + sizeof(Header);
+			}
+
+			size_t setup_length() const noexcept {
+				return header()->setup_length;
+			}
+
+			const xcb_query_extension_reply_t* randr() const noexcept {
+				return reinterpret_cast<const xcb_query_extension_reply_t*>(
+					setup() + align(setup_length())
+				);
+			}
+
+			// Recorded reply to the keyboard mapping request made by `xcb_key_symbols_alloc`.
+			const std::byte* keymap() const noexcept {
+				return setup() + align(setup_length()) + align(sizeof(xcb_query_extension_reply_t));
+			}
+
+			size_t keymap_length() const noexcept {
+				return header()->keymap_length;
+			}
+
+
+			// Append a record, does nothing unless recording.
+			void write(const Kind kind, const void* payload, const size_t length) {
+				if (not recording())
+					return;
+
+				const Record record{kind, {}, static_cast<uint32_t>(length), elapsed()};
+
+				std::fwrite(&record, sizeof(Record), 1, file.get());
+				write_padded(payload, length);
+			}
+
+
+			// Mark the start of a new batch of events. The previous batch is
+			// flushed to disk so that a crash loses at most one batch.
+			void batch() {
+				if (not recording())
+					return;
+
+				std::fflush(file.get());
+				write(Kind::batch, nullptr, 0);
+			}
+
+
+			// Move on to the next recorded batch, returns false at the end of the trace.
+			bool next_batch() {
+				const auto record = peek();
+
+				if (not record or record->kind != Kind::batch)
+					return false;
+
+				take(Kind::batch);
+				return true;
+			}
+
+
+			// Next event of the current batch or nullptr once the batch is over.
+			xcb_generic_event_t* next_event() {
+				const auto record = peek();
+
+				if (not record or record->kind != Kind::event)
+					return nullptr;
+
+				return static_cast<xcb_generic_event_t*>(take(Kind::event));
+			}
+
+
+			// Next recorded motion hint reply or nullptr if none was handled here.
+			xcb_query_pointer_reply_t* next_motion() {
+				const auto record = peek();
+
+				if (not record or record->kind != Kind::motion)
+					return nullptr;
+
+				return static_cast<xcb_query_pointer_reply_t*>(take(Kind::motion));
+			}
+
+
+			// Next recorded reply or error.
+			void* next_reply() {
+				return take(Kind::reply);
+			}
+
+			xcb_generic_error_t* next_check() {
+				return static_cast<xcb_generic_error_t*>(take(Kind::check));
+			}
+
+
+			size_t records_replayed() const noexcept {
+				return records;
+			}
+
+			// Timestamp of the last record which was replayed.
+			uint64_t replayed_ns() const noexcept {
+				return last_timestamp;
+			}
+
+			bool failed() const noexcept {
+				return desynced;
+			}
+	};
+
+
+
+	/*
+		Create a connection which behaves like the one a trace was recorded on
+		but never talks to an X server.
+
+		The recorded setup is fed to `xcb_connect_to_fd` through a socket pair,
+		followed by the replies to the first two requests: the randr extension
+		query which we make here, and the keyboard mapping which
+		`xcb_key_symbols_alloc` asks for when the connection is constructed.
+		Everything else we send is read and discarded by a child process so
+		that writes never block, replies come from the trace.
+
+		example:
+			fluke::Connection conn{std::move(trace)};
+	*/
+	inline xcb_connection_t* replay_connection(const fluke::Trace& trace) {
+		int fds[2];
+
+		if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1)
+			return xcb_connect_to_fd(-1, nullptr);
+
+		// Replies are matched to requests by sequence number, stamp them
+		// with the order the requests are made in.
+		auto randr = *trace.randr();
+		randr.sequence = 1;
+
+		std::vector<std::byte> keymap{trace.keymap(), trace.keymap() + trace.keymap_length()};
+		reinterpret_cast<xcb_get_keyboard_mapping_reply_t*>(keymap.data())->sequence = 2;
+
+		// The server end of the socket pair has plenty of buffer space for these.
+		if (
+			write(fds[1], trace.setup(), trace.setup_length()) == -1 or
+			write(fds[1], &randr, sizeof(randr)) == -1 or
+			write(fds[1], keymap.data(), keymap.size()) == -1
+		) {
+			close(fds[0]);
+			close(fds[1]);
+			return xcb_connect_to_fd(-1, nullptr);
+		}
+
+		// Fork twice so the process draining the socket belongs to init,
+		// which reaps it once we hang up. Only the middle process is ours.
+		if (const pid_t pid = fork(); pid == 0) {
+			if (fork() != 0)
+				_exit(EXIT_SUCCESS);
+
+			close(fds[0]);
+
+			char buffer[4096];
+			while (read(fds[1], buffer, sizeof(buffer)) > 0) {}
+
+			_exit(EXIT_SUCCESS);
+		}
+
+		else if (pid != -1)
+			waitpid(pid, nullptr, 0);
+
+		close(fds[1]);
+
+		const auto conn = xcb_connect_to_fd(fds[0], nullptr);
+
+		// Request 1, answered by the recorded randr reply. The keyboard
+		// mapping is request 2 no matter what the caller does next.
+		xcb_prefetch_extension_data(conn, &xcb_randr_id);
+
+		return conn;
+	}
+
+
+
+	namespace detail {
+		// Record a reply when recording or return the recorded reply when
+		// replaying, the real reply is never going to arrive so we tell xcb
+		// to forget about it.
+		template <typename T, typename F>
+		inline T* trace_reply(xcb_connection_t* conn, fluke::Trace& trace, const unsigned sequence, F&& func) {
+			if (trace.replaying()) {
+				xcb_discard_reply(conn, sequence);
+				return static_cast<T*>(trace.next_reply());
+			}
+
+			T* reply = func();
+
+			if (trace.recording()) {
+				const auto generic = reinterpret_cast<const xcb_generic_reply_t*>(reply);
+				trace.write(Trace::Kind::reply, reply, reply ? 32 + generic->length * 4 : 0);
+			}
+
+			return reply;
+		}
+	}
+}
+
+#endif
@@ -96,6 +96,14 @@ namespace fluke {
 		auto [x, y] = p;
 		return (os << '(' << x << ',' << y << ')');
 	}
+
+
+
+	// A window and the rect it should occupy.
+	struct Placement {
+		xcb_window_t win;
+		fluke::Rect rect;
+	};
 }
 
 #endif
@@ -0,0 +1,205 @@
+#ifndef FLUKE_WINDOW_CACHE_HPP
+#define FLUKE_WINDOW_CACHE_HPP
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	// Everything we remember about a top-level window.
+	struct Client {
+		xcb_window_t win;
+		fluke::Rect rect;
+
+		bool mapped;
+		bool ignored;  // override_redirect
+	};
+
+
+
+	/*
+		A client-side mirror of the children of the root window.
+
+		The cache is filled once at startup and is kept up to date by
+		the structure events which X sends us for the children of the root
+		window. This allows us to answer questions like "which windows
+		are mapped?" without a round trip to the server.
+
+		Clients are kept in stacking order, bottom-most first, which is the
+		same order that `query_tree` returns children in.
+
+		Windows which are mapped and not ignored are also kept in a spatial
+		index (see `fluke::SpatialGrid`) for queries like "nearest window to
+		the right". Clients can only be changed through the functions below
+		so that the index never goes stale.
+
+		example:
+			for (const auto& [win, rect, mapped, ignored]: conn.windows())
+				std::cout << fluke::to_hex(win) << ' ' << rect << '\n';
+	*/
+	class WindowCache {
+		// Data
+		private:
+			std::vector<fluke::Client> clients;
+			fluke::SpatialGrid spatial_index;
+
+
+		// Helpers
+		private:
+			auto find_iter(const xcb_window_t win) {
+				return std::find_if(clients.begin(), clients.end(), [win] (const auto& c) {
+					return c.win == win;
+				});
+			}
+
+			auto find_iter(const xcb_window_t win) const {
+				return std::find_if(clients.begin(), clients.end(), [win] (const auto& c) {
+					return c.win == win;
+				});
+			}
+
+
+			// Only windows which can be focused are indexed.
+			void reindex(const fluke::Client& client) {
+				if (client.mapped and not client.ignored)
+					spatial_index.insert(client.win, client.rect);
+
+				else
+					spatial_index.erase(client.win);
+			}
+
+
+			template <typename F>
+			bool modify(const xcb_window_t win, F&& func) {
+				const auto it = find_iter(win);
+
+				if (it == clients.end())
+					return false;
+
+				func(*it);
+				reindex(*it);
+
+				return true;
+			}
+
+
+		// Constructors
+		public:
+			WindowCache() = default;
+
+			explicit WindowCache(const fluke::Rect& bounds):
+				clients(),
+				spatial_index(bounds)
+			{
+
+			}
+
+
+		// Functions
+		public:
+			// Returns nullptr if the window is not known.
+			const fluke::Client* find(const xcb_window_t win) const {
+				const auto it = find_iter(win);
+				return it == clients.end() ? nullptr : &*it;
+			}
+
+
+			// Add a window to the top of the stack. If the window is already
+			// known, it is updated in place instead.
+			void insert(const fluke::Client& client) {
+				const auto it = find_iter(client.win);
+
+				if (it != clients.end())
+					*it = client;
+
+				else
+					clients.emplace_back(client);
+
+				reindex(client);
+			}
+
+
+			void erase(const xcb_window_t win) {
+				clients.erase(std::remove_if(clients.begin(), clients.end(), [win] (const auto& c) {
+					return c.win == win;
+				}), clients.end());
+
+				spatial_index.erase(win);
+			}
+
+
+			// Update a known window, these return false if the window is unknown.
+			bool set_rect(const xcb_window_t win, const fluke::Rect& rect) {
+				return modify(win, [&rect] (auto& c) { c.rect = rect; });
+			}
+
+			bool set_mapped(const xcb_window_t win, const bool mapped) {
+				return modify(win, [mapped] (auto& c) { c.mapped = mapped; });
+			}
+
+			bool set_ignored(const xcb_window_t win, const bool ignored) {
+				return modify(win, [ignored] (auto& c) { c.ignored = ignored; });
+			}
+
+
+			// Place `win` directly above `sibling` in the stack.
+			// If `sibling` is `XCB_NONE`, `win` is placed at the bottom.
+			void restack(const xcb_window_t win, const xcb_window_t sibling) {
+				auto it = find_iter(win);
+
+				if (it == clients.end())
+					return;
+
+				const fluke::Client client = *it;
+				clients.erase(it);
+
+				auto pos = clients.begin();
+
+				if (sibling != XCB_NONE) {
+					pos = find_iter(sibling);
+
+					// Unknown sibling, leave the window on top.
+					if (pos != clients.end())
+						++pos;
+				}
+
+				clients.insert(pos, client);
+			}
+
+
+			void clear() noexcept {
+				clients.clear();
+				spatial_index.clear();
+			}
+
+
+			// Spatial index of the mapped windows which aren't ignored.
+			const fluke::SpatialGrid& index() const noexcept {
+				return spatial_index;
+			}
+
+			// Change the area covered by the spatial index, used when the
+			// screen is resized.
+			void resize_index(const fluke::Rect& bounds) {
+				spatial_index.resize(bounds);
+			}
+
+			auto size() const noexcept {
+				return clients.size();
+			}
+
+
+		// Iterators
+		public:
+			auto begin() const noexcept { return clients.begin(); }
+			auto end() const noexcept { return clients.end(); }
+
+			auto rbegin() const noexcept { return clients.rbegin(); }
+			auto rend() const noexcept { return clients.rend(); }
+	};
+}
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef FLUKE_WORKSPACES_HPP
+#define FLUKE_WORKSPACES_HPP
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Workspaces for every display.
+
+		Each display (keyed by its CRTC) has `config::WORKSPACE_COUNT`
+		workspaces of which one is active. Each workspace keeps its own list
+		of clients ordered by when they were last focused, most recent last,
+		so switching to a workspace knows which window to focus and which
+		windows to map without asking X about anything.
+
+		Windows on inactive workspaces are unmapped by us. We remember which
+		unmaps we caused so that the UnmapNotify they generate isn't mistaken
+		for the client withdrawing its window.
+
+		example:
+			auto& ws = conn.workspaces();
+
+			ws.add(win, crtc);
+			ws.focus(win);
+
+			for (xcb_window_t w: ws.clients(crtc, ws.active(crtc)))
+				std::cout << fluke::to_hex(w) << '\n';
+	*/
+	class Workspaces {
+		// Constants
+		public:
+			static constexpr size_t count = config::WORKSPACE_COUNT;
+
+
+		// Types
+		private:
+			struct Display {
+				std::array<std::vector<xcb_window_t>, count> workspaces;
+				size_t active = 0;
+			};
+
+			struct Location {
+				xcb_randr_crtc_t crtc;
+				size_t index;
+			};
+
+
+		// Data
+		private:
+			std::unordered_map<xcb_randr_crtc_t, Display> displays;
+			std::unordered_map<xcb_window_t, Location> locations;
+
+			// Windows we have unmapped whose UnmapNotify hasn't arrived yet.
+			std::vector<xcb_window_t> unmapping;
+
+
+		// Helpers
+		private:
+			std::vector<xcb_window_t>& list(const Location& loc) {
+				return displays[loc.crtc].workspaces[loc.index];
+			}
+
+			static void erase_from(std::vector<xcb_window_t>& clients, const xcb_window_t win) {
+				clients.erase(std::remove(clients.begin(), clients.end(), win), clients.end());
+			}
+
+
+		// Functions
+		public:
+			// Add `win` to the active workspace of `crtc` as its most recently
+			// focused window, does nothing if the window already has a workspace.
+			void add(const xcb_window_t win, const xcb_randr_crtc_t crtc) {
+				if (contains(win))
+					return;
+
+				auto& disp = displays[crtc];
+
+				disp.workspaces[disp.active].emplace_back(win);
+				locations.emplace(win, Location{ crtc, disp.active });
+			}
+
+
+			// Append `win` to workspace `index` of `crtc` as its most recently
+			// focused window, used when restoring a snapshot.
+			void place(const xcb_window_t win, const xcb_randr_crtc_t crtc, const size_t index) {
+				if (contains(win) or index >= count)
+					return;
+
+				displays[crtc].workspaces[index].emplace_back(win);
+				locations.emplace(win, Location{ crtc, index });
+			}
+
+
+			// Call `func(crtc, active, workspaces)` for every display.
+			template <typename F>
+			void for_each(F&& func) const {
+				for (const auto& [crtc, disp]: displays)
+					func(crtc, disp.active, disp.workspaces);
+			}
+
+
+			void remove(const xcb_window_t win) {
+				const auto it = locations.find(win);
+
+				if (it == locations.end())
+					return;
+
+				erase_from(list(it->second), win);
+				locations.erase(it);
+			}
+
+
+			// Move `win` to the end of its workspace's focus history.
+			void focus(const xcb_window_t win) {
+				const auto it = locations.find(win);
+
+				if (it == locations.end())
+					return;
+
+				auto& clients = list(it->second);
+
+				// Already the most recently focused window.
+				if (not clients.empty() and clients.back() == win)
+					return;
+
+				erase_from(clients, win);
+				clients.emplace_back(win);
+			}
+
+
+			/*
+				Move `win` to workspace `index` on the same display. Returns
+				true if the window has to be hidden because the workspace it
+				moved to isn't active.
+			*/
+			bool move(const xcb_window_t win, const size_t index) {
+				const auto it = locations.find(win);
+
+				if (it == locations.end() or index >= count or it->second.index == index)
+					return false;
+
+				erase_from(list(it->second), win);
+
+				it->second.index = index;
+				list(it->second).emplace_back(win);
+
+				return displays[it->second.crtc].active != index;
+			}
+
+
+			/*
+				Move every window of the display `from` to the same workspace
+				of the display `into` and forget about `from`, used when a
+				display goes away. The windows go behind the windows already
+				there in focus order.
+			*/
+			void merge(const xcb_randr_crtc_t from, const xcb_randr_crtc_t into) {
+				const auto it = displays.find(from);
+
+				if (it == displays.end() or from == into)
+					return;
+
+				const Display source = std::move(it->second);
+				displays.erase(it);
+
+				auto& target = displays[into];
+
+				for (size_t i = 0; i < count; ++i) {
+					const auto& moved = source.workspaces[i];
+					target.workspaces[i].insert(target.workspaces[i].begin(), moved.begin(), moved.end());
+
+					for (xcb_window_t win: moved)
+						locations[win] = Location{ into, i };
+				}
+			}
+
+
+			// Make workspace `index` the active workspace of `crtc`.
+			void activate(const xcb_randr_crtc_t crtc, const size_t index) {
+				if (index < count)
+					displays[crtc].active = index;
+			}
+
+
+			bool contains(const xcb_window_t win) const {
+				return locations.find(win) != locations.end();
+			}
+
+			// True if `win` belongs to a workspace which isn't active.
+			bool is_hidden(const xcb_window_t win) const {
+				const auto it = locations.find(win);
+
+				if (it == locations.end())
+					return false;
+
+				return displays.at(it->second.crtc).active != it->second.index;
+			}
+
+			// Display which the workspace of `win` belongs to or `XCB_NONE`.
+			xcb_randr_crtc_t display_of(const xcb_window_t win) const {
+				const auto it = locations.find(win);
+				return it == locations.end() ? XCB_NONE : it->second.crtc;
+			}
+
+			// Index of the workspace of `win`, only valid if `contains(win)`.
+			size_t index_of(const xcb_window_t win) const {
+				const auto it = locations.find(win);
+				return it == locations.end() ? 0 : it->second.index;
+			}
+
+			size_t active(const xcb_randr_crtc_t crtc) {
+				return displays[crtc].active;
+			}
+
+			// Clients of a workspace, most recently focused last.
+			const std::vector<xcb_window_t>& clients(const xcb_randr_crtc_t crtc, const size_t index) {
+				return displays[crtc].workspaces[index];
+			}
+
+
+			// Remember that we are unmapping `win`.
+			void expect_unmap(const xcb_window_t win) {
+				unmapping.emplace_back(win);
+			}
+
+			// Returns true if the unmap of `win` was caused by us.
+			bool take_unmap(const xcb_window_t win) {
+				const auto it = std::find(unmapping.begin(), unmapping.end(), win);
+
+				if (it == unmapping.end())
+					return false;
+
+				*it = unmapping.back();
+				unmapping.pop_back();
+
+				return true;
+			}
+	};
+}
+
+#endif
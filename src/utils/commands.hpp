@@ -0,0 +1,34 @@
+#ifndef FLUKE_COMMANDS_HPP
+#define FLUKE_COMMANDS_HPP
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+
+	using CommandCallback = bool(*)(fluke::Connection&, const int32_t*);
+
+	// A command which can be run over the control socket, `argc` integer
+	// arguments are passed to `func` which returns false if they are invalid.
+	struct Command {
+		const char* name;
+		uint32_t argc;
+		fluke::CommandCallback func;
+	};
+
+
+	// Basically an array with a known T.
+	template <size_t N>
+	struct Commands: std::array<fluke::Command, N> {};
+
+	// Deduction guide so we can automatically determine
+	// the size of the array.
+	template <class... Ts>
+	Commands(Ts...) -> Commands<sizeof...(Ts)>;
+}
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef FLUKE_UTILS_DRAG_HPP
+#define FLUKE_UTILS_DRAG_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Grab the drag buttons on the root window while `DRAG_MODIFIER` is
+		held, see `config/options.hpp`.
+
+		example:
+			fluke::register_buttons(conn);
+	*/
+	inline void register_buttons(fluke::Connection& conn) {
+		namespace conf = fluke::config;
+
+		constexpr uint16_t mask =
+			XCB_EVENT_MASK_BUTTON_PRESS |
+			XCB_EVENT_MASK_BUTTON_RELEASE |
+			XCB_EVENT_MASK_BUTTON_MOTION |
+			fluke::XCB_MOTION_HINT_MASK
+		;
+
+		for (const auto button: { conf::DRAG_MOVE_BUTTON, conf::DRAG_RESIZE_BUTTON }) {
+			// Grab under every combination of lock modifiers like our keybindings.
+			for (const auto& mod: fluke::keys::lock_combinations)
+				fluke::grab_button(
+					conn, false, conn.root(), mask,
+					XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
+					XCB_NONE, XCB_NONE,
+					static_cast<uint8_t>(button), static_cast<uint16_t>(conf::DRAG_MODIFIER | mod)
+				);
+		}
+	}
+
+
+
+	/*
+		Snap one edge of a window to the nearest edge of `[lo, hi]` if it
+		is within `SNAP_DISTANCE` of it. `pos` is the start of the window
+		and `size` is its extent including borders.
+
+		example:
+			x = fluke::snap_edge(x, w, display_x, display_x + display_w);
+	*/
+	inline int snap_edge(const int pos, const int size, const int lo, const int hi) {
+		if (std::abs(pos - lo) <= fluke::config::SNAP_DISTANCE)
+			return lo;
+
+		if (std::abs(pos + size - hi) <= fluke::config::SNAP_DISTANCE)
+			return hi - size;
+
+		return pos;
+	}
+
+
+
+	/*
+		Start moving or resizing the top-level window under the pointer.
+
+		The pointer is already grabbed by our passive button grab, we take
+		it over to also receive motion with the button released in case
+		the press was lost. The reply is discarded so no round trip is made,
+		if X refuses the grab the button release still ends the drag.
+
+		example:
+			fluke::begin_drag(conn, e->child, fluke::Point{ e->root_x, e->root_y }, fluke::Drag::Mode::move);
+	*/
+	inline void begin_drag(fluke::Connection& conn, xcb_window_t win, const fluke::Point& pointer, const fluke::Drag::Mode mode) {
+		if (not fluke::is_valid_window(conn, win))
+			return;
+
+		// Only windows we manage can be dragged.
+		const auto client = conn.windows().find(win);
+
+		if (not client or client->ignored or not client->mapped)
+			return;
+
+		FLUKE_DEBUG_NOTICE_SUB(
+			mode == fluke::Drag::Mode::move ? "move" : "resize",
+			" '", tinge::fg::make_yellow(fluke::to_hex(win)), "'"
+		)
+
+		auto& drag = conn.drag();
+
+		drag.win = win;
+		drag.mode = mode;
+		drag.origin = pointer;
+		drag.start = client->rect;
+		drag.rect = client->rect;
+
+		// A dragged window floats above everything else.
+		fluke::untile_window(conn, win);
+		fluke::configure_window(conn, win, XCB_CONFIG_WINDOW_STACK_MODE, XCB_STACK_MODE_ABOVE);
+		fluke::set_input_focus(conn, XCB_INPUT_FOCUS_PARENT, win);
+
+		const auto cookie = fluke::grab_pointer(
+			conn, false, conn.root(),
+			XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION | fluke::XCB_MOTION_HINT_MASK,
+			XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
+			XCB_NONE, XCB_NONE
+		);
+
+		xcb_discard_reply(conn, cookie.cookie.sequence);
+	}
+
+
+
+	/*
+		Move or resize the dragged window to follow the pointer.
+
+		Edges snap to the display under the pointer, gutters, gaps and
+		borders are taken into account so a snapped window lines up with
+		tiled ones. Displays come from the display cache so this never
+		has to ask X for anything. Nothing is sent unless the geometry
+		actually changed.
+
+		example:
+			fluke::update_drag(conn, fluke::Point{ e->root_x, e->root_y });
+	*/
+	inline void update_drag(fluke::Connection& conn, const fluke::Point& pointer) {
+		namespace conf = fluke::config;
+
+		auto& drag = conn.drag();
+
+		if (not drag.active())
+			return;
+
+		const int dx = pointer.x - drag.origin.x;
+		const int dy = pointer.y - drag.origin.y;
+
+		const auto [sx, sy, sw, sh] = drag.start;
+
+		// Find the display the pointer is on, falling back to the one
+		// nearest to the window if it's in between displays.
+		fluke::Rect display = fluke::get_nearest_display(conn, drag.rect).rect;
+
+		for (const auto& disp: fluke::get_displays(conn)) {
+			if (fluke::aabb(disp.rect, pointer)) {
+				display = disp.rect;
+				break;
+			}
+		}
+
+		const auto [disp_x, disp_y, disp_w, disp_h] = fluke::get_adjusted_display_rect(display);
+
+		const int lo_x = disp_x + conf::GAP;
+		const int lo_y = disp_y + conf::GAP;
+		const int hi_x = disp_x + disp_w - conf::GAP;
+		const int hi_y = disp_y + disp_h - conf::GAP;
+
+		constexpr int borders = conf::BORDER_SIZE * 2;
+
+		fluke::Rect rect = drag.rect;
+
+		if (drag.mode == fluke::Drag::Mode::move) {
+			rect.x = static_cast<decltype(rect.x)>(fluke::snap_edge(sx + dx, sw + borders, lo_x, hi_x));
+			rect.y = static_cast<decltype(rect.y)>(fluke::snap_edge(sy + dy, sh + borders, lo_y, hi_y));
+		}
+
+		else {
+			// Only the bottom right corner moves so only it snaps.
+			const int right = fluke::snap_edge(sx + sw + dx + borders, 0, lo_x, hi_x);
+			const int bottom = fluke::snap_edge(sy + sh + dy + borders, 0, lo_y, hi_y);
+
+			rect.w = static_cast<decltype(rect.w)>(std::max(right - sx - borders, conf::DRAG_MIN_SIZE));
+			rect.h = static_cast<decltype(rect.h)>(std::max(bottom - sy - borders, conf::DRAG_MIN_SIZE));
+		}
+
+		if (rect == drag.rect)
+			return;
+
+		drag.rect = rect;
+
+		const auto [x, y, w, h] = rect;
+		fluke::configure_window(conn, drag.win, fluke::XCB_MOVE_RESIZE, x, y, w, h);
+	}
+
+
+
+	/*
+		Finish a drag with one last update at the final pointer position
+		and let go of the pointer.
+
+		example:
+			fluke::end_drag(conn, fluke::Point{ e->root_x, e->root_y });
+	*/
+	inline void end_drag(fluke::Connection& conn, const fluke::Point& pointer) {
+		if (not conn.drag().active())
+			return;
+
+		fluke::update_drag(conn, pointer);
+		fluke::ungrab_pointer(conn);
+
+		conn.drag().reset();
+	}
+}
+
+#endif
@@ -3,11 +3,65 @@
 
 #pragma once
 
+#include <csignal>
+
 extern "C" {
+	#include <spawn.h>
 	#include <unistd.h>
 }
 
 namespace fluke {
+	/*
+		Launches a program with `posix_spawnp`, `argv` is terminated by
+		nullptr.
+
+		Nothing is forked so launching costs the same no matter how much
+		memory we use. The program gets its own session, an empty signal
+		mask and none of our files, everything we open is close-on-exec.
+		It is added to `fluke::children()` and reaped by the event loop
+		when it exits. Returns the pid of the program or -1.
+
+		example:
+			constexpr std::array<const char*, 3> argv{ "st", "-n", nullptr };
+			const pid_t pid = fluke::spawn(argv.data());
+	*/
+	inline pid_t spawn(const char* const* argv) {
+		// Don't launch anything while replaying a trace.
+		if (fluke::detail::replay_active)
+			return -1;
+
+		posix_spawnattr_t attr;
+
+		if (posix_spawnattr_init(&attr) != 0)
+			return -1;
+
+		// Signals the event loop reads from a file are blocked, the
+		// program shouldn't inherit that.
+		sigset_t mask;
+		sigemptyset(&mask);
+
+		pid_t pid = -1;
+
+		const bool spawned =
+			posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSID) == 0 and
+			posix_spawnattr_setsigmask(&attr, &mask) == 0 and
+			posix_spawnp(&pid, argv[0], nullptr, &attr, const_cast<char* const*>(argv), environ) == 0
+		;
+
+		posix_spawnattr_destroy(&attr);
+
+		if (not spawned) {
+			FLUKE_DEBUG_ERROR("cannot run '", argv[0], "'!")
+			return -1;
+		}
+
+		fluke::children().add(pid, argv[0]);
+
+		return pid;
+	}
+
+
+
 	/*
 		Launches a program specified by first argument,
 		remaining arguments are passed to the new processes
@@ -23,13 +77,24 @@ namespace fluke {
 	inline bool exec(const char* arg, Ts&&... args) {
 		FLUKE_DEBUG_NOTICE("run '", tinge::fg::make_yellow(arg), tinge::strcat(" ", tinge::fg::make_yellow(args))..., "'")
 
-		if (fork())
-			return false;
+		const char* const argv[] = { arg, args..., nullptr };
+		return fluke::spawn(argv) != -1;
+	}
 
-		if (setsid() == -1)
-			return false;
 
-		return execlp(arg, arg, args..., (char*)nullptr) != -1;
+
+	/*
+		Like `fluke::exec` but the program and its arguments are given as
+		an array terminated by nullptr. Returns the pid of the program or -1.
+
+		example:
+			constexpr std::array<const char*, 3> argv{ "st", "-n", nullptr };
+			fluke::exec_argv(argv.data());
+	*/
+	inline pid_t exec_argv(const char* const* argv) {
+		FLUKE_DEBUG_NOTICE("run '", tinge::fg::make_yellow(argv[0]), "'")
+
+		return fluke::spawn(argv);
 	}
 }
 
@@ -4,8 +4,10 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <fluke.hpp>
 
 
@@ -14,6 +16,9 @@ namespace fluke {
 		Sends a series of requests all at once then immediatetely after
 		blocks until the replies are fetched.
 
+		For several kinds of request or requests which depend on the
+		reply to another request, use `fluke::Pipeline` instead.
+
 		A new request is fired off for each argument in `changing_arg`.
 		For every request, this is the only argument that changes, the other
 		argument remain constant for all requests.
@@ -33,6 +38,9 @@ namespace fluke {
 		std::vector<decltype(func(changing_arg.front(), std::forward<Ts>(args)...))> request;
 		std::vector<decltype(fluke::get(conn, request.front()))> reply;
 
+		request.reserve(changing_arg.size());
+		reply.reserve(changing_arg.size());
+
 		// Fire off a request for each argument in `changing_arg` while passing
 		// the unchanging args too.
 		for (const auto& x: changing_arg)
@@ -87,10 +95,123 @@ namespace fluke {
 
 
 
+	/*
+		Queue the requests needed to add `win` to the window cache on `pipe`.
+		If the window is already in the cache it is updated in place, which
+		keeps its position in the stack. Windows which are destroyed before
+		the replies arrive are removed.
+
+		example:
+			fluke::Pipeline pipe{conn};
+			fluke::request_window(pipe, conn.windows(), win);
+			pipe.run();
+	*/
+	inline void request_window(fluke::Pipeline& pipe, fluke::WindowCache& cache, xcb_window_t win) {
+		auto& conn = pipe.connection();
+
+		pipe.send(fluke::get_window_attributes(conn, win), [&cache, win] (auto&, fluke::GetWindowAttributesReply attr) {
+			// The window was destroyed before we could ask about it.
+			if (not attr) {
+				cache.erase(win);
+				return;
+			}
+
+			const auto client = cache.find(win);
+
+			cache.insert(fluke::Client{
+				win,
+				client ? client->rect : fluke::Rect{},
+				fluke::is_mapped(attr),
+				fluke::is_ignored(attr)
+			});
+		});
+
+		pipe.send(fluke::get_geometry(conn, win), [&cache, win] (auto&, fluke::GetGeometryReply geom) {
+			if (not geom)
+				cache.erase(win);
+
+			else
+				cache.set_rect(win, fluke::as_rect(geom));
+		});
+	}
+
+
+
+	/*
+		Queue the requests needed to fill the window cache with every child of
+		the root window on `pipe`. The attributes and geometry of every child
+		are requested as soon as the tree arrives.
+
+		This is the only place where we ask X for the whole window tree,
+		afterwards the cache is kept up to date by structure events.
+
+		example:
+			fluke::Pipeline pipe{conn};
+			fluke::request_window_cache(pipe);
+			pipe.run();
+	*/
+	inline void request_window_cache(fluke::Pipeline& pipe) {
+		auto& conn = pipe.connection();
+		auto& cache = conn.windows();
+
+		pipe.send(fluke::query_tree(conn, conn.root()), [&cache] (fluke::Pipeline& queue, fluke::QueryTreeReply tree) {
+			cache.clear();
+
+			if (not tree)
+				return;
+
+			// Children are returned bottom-most first which is the order the cache keeps them in.
+			const auto children = xcb_query_tree_children(tree.get());
+			const auto length = xcb_query_tree_children_length(tree.get());
+
+			for (int i = 0; i < length; ++i)
+				fluke::request_window(queue, cache, children[i]);
+		});
+	}
+
+
+
+	/*
+		Fill the window cache with every child of the root window.
+
+		example:
+			fluke::build_window_cache(conn);
+	*/
+	inline void build_window_cache(fluke::Connection& conn) {
+		fluke::Pipeline pipe{conn};
+		fluke::request_window_cache(pipe);
+		pipe.run();
+	}
+
+
+
+	/*
+		Get the rect of a window. This is answered from the window cache
+		and only falls back to asking X if the window is unknown to us.
+
+		example:
+			auto [x, y, w, h] = fluke::get_window_rect(conn, fluke::get_focused_window(conn));
+	*/
+	inline fluke::Rect get_window_rect(fluke::Connection& conn, xcb_window_t win) {
+		if (const auto client = conn.windows().find(win))
+			return client->rect;
+
+		const auto geom = fluke::get(conn, fluke::get_geometry(conn, win));
+
+		if (not geom)
+			return fluke::Rect{};
+
+		return fluke::as_rect(geom);
+	}
+
+
+
 	/*
 		Returns a vector of xcb_window_t IDs which contains all of the known windows.
 		This includes mapped(visible) and unmapped(invisible) windows.
 
+		Windows are ordered top-most first.
+
 		example:
 			auto windows = fluke::get_all_windows(conn);
 
@@ -98,25 +219,15 @@ namespace fluke {
 				std::cout << fluke::to_hex(win) << '\n';
 	*/
 	inline auto get_all_windows(fluke::Connection& conn) {
-		// Get all windows.
-		auto windows = fluke::get_tree(conn);
-
-		// Get window attributes for every ID in `windows`.
-		const auto attrs = fluke::dispatch_consume(conn, [&conn] (xcb_window_t win) {
-			return fluke::get_window_attributes( conn, win );
-		}, windows);
-
-
-		// We use `i` to allow indexing `attrs` while simultaneously indexing `windows`.
-		decltype(attrs)::size_type i = 0;
+		std::vector<xcb_window_t> windows;
+		windows.reserve(conn.windows().size());
 
-		// Remove windows which have override_redirect set, they have asked to
+		// Skip windows which have override_redirect set, they have asked to
 		// not be managed by the window manager.
-		const auto should_remove = [&] (xcb_window_t) {
-			return fluke::is_ignored(attrs[i++]);
-		};
-
-		windows.erase(std::remove_if(windows.begin(), windows.end(), should_remove), windows.end());
+		for (auto it = conn.windows().rbegin(); it != conn.windows().rend(); ++it) {
+			if (not it->ignored)
+				windows.emplace_back(it->win);
+		}
 
 		return windows;
 	}
@@ -134,30 +245,15 @@ namespace fluke {
 				std::cout << fluke::to_hex(win) << '\n';
 	*/
 	inline auto get_mapped_windows(fluke::Connection& conn) {
-		// Get all windows.
-		auto windows = fluke::get_tree(conn);
-
-		// Get window attributes for every ID in `windows`.
-		const auto attrs = fluke::dispatch_consume(conn, [&conn] (xcb_window_t win) {
-			return fluke::get_window_attributes( conn, win );
-		}, windows);
+		std::vector<xcb_window_t> windows;
+		windows.reserve(conn.windows().size());
 
-
-		// We use `i` to allow indexing `attrs` while simultaneously indexing `windows`.
-		decltype(attrs)::size_type i = 0;
-
-		// Remove windows which have override_redirect set and are unmapped,
+		// Skip windows which have override_redirect set and are unmapped,
 		// they have asked to not be managed by the window manager.
-		const auto should_remove = [&] (xcb_window_t) {
-			const auto& attr = attrs[i++];
-
-			return
-				fluke::is_ignored(attr) or
-				not fluke::is_mapped(attr)
-			;
-		};
-
-		windows.erase(std::remove_if(windows.begin(), windows.end(), should_remove), windows.end());
+		for (auto it = conn.windows().rbegin(); it != conn.windows().rend(); ++it) {
+			if (not it->ignored and it->mapped)
+				windows.emplace_back(it->win);
+		}
 
 		return windows;
 	}
@@ -235,7 +331,11 @@ namespace fluke {
 
 	/*
 		Returns a vector of xcb_randr_crtc_t structures which contains the
-		attributes of all connected displays.
+		attributes of all connected displays. A CRTC shared by several
+		outputs is only returned once.
+
+		The screen resources list both outputs and CRTCs so the info for
+		both is requested in the same wave.
 
 		example:
 			for (auto& disp: fluke::get_crtcs(conn)) {
@@ -244,24 +344,150 @@ namespace fluke {
 			}
 	*/
 	inline auto get_crtcs(fluke::Connection& conn) {
-		const auto outputs = fluke::get_screen_resources(conn);
+		std::vector<std::pair<xcb_randr_crtc_t, fluke::RandrGetCrtcInfoReply>> crtcs;
+		std::vector<xcb_randr_crtc_t> connected;
+
+		{
+			fluke::Pipeline pipe{conn};
+
+			pipe.send(fluke::randr_get_screen_resources_current(conn, conn.root()), [&conn, &crtcs, &connected] (
+				fluke::Pipeline& queue, fluke::RandrGetScreenResourcesCurrentReply res
+			) {
+				if (not res)
+					return;
+
+				const auto outputs = xcb_randr_get_screen_resources_current_outputs(res.get());
+				const auto crtc_ids = xcb_randr_get_screen_resources_current_crtcs(res.get());
+
+				for (int i = 0; i < xcb_randr_get_screen_resources_current_outputs_length(res.get()); ++i) {
+					queue.send(fluke::randr_get_output_info(conn, outputs[i]), [&connected] (auto&, fluke::RandrGetOutputInfoReply info) {
+						if (info and fluke::is_connected(info) and info->crtc != XCB_NONE)
+							connected.emplace_back(info->crtc);
+					});
+				}
+
+				for (int i = 0; i < xcb_randr_get_screen_resources_current_crtcs_length(res.get()); ++i) {
+					const xcb_randr_crtc_t crtc = crtc_ids[i];
+
+					queue.send(fluke::randr_get_crtc_info(conn, crtc), [&crtcs, crtc] (auto&, fluke::RandrGetCrtcInfoReply info) {
+						crtcs.emplace_back(crtc, std::move(info));
+					});
+				}
+			});
+		}
 
-		// Get output info for each display.
-		auto output_info = fluke::dispatch_consume(conn, [&conn] (xcb_randr_output_t out) {
-			return fluke::randr_get_output_info(conn, out);
-		}, outputs);
+		// Keep the CRTCs which have a connected output, in output order.
+		std::vector<fluke::RandrGetCrtcInfoReply> displays;
 
+		for (const xcb_randr_crtc_t crtc: connected) {
+			const auto it = std::find_if(crtcs.begin(), crtcs.end(), [crtc] (const auto& x) {
+				return x.first == crtc;
+			});
 
-		// Remove disconnected displays.
-		output_info.erase(std::remove_if(output_info.begin(), output_info.end(), [] (const auto& info) {
-			return not fluke::is_connected(info) or info->crtc == XCB_NONE;
-		}), output_info.end());
+			if (it != crtcs.end() and it->second)
+				displays.emplace_back(std::move(it->second));
+		}
+
+		return displays;
+	}
+
+
+
+	/*
+		Queue the requests needed to rebuild the display cache on `pipe`.
+
+		The screen resources list both outputs and CRTCs so the info for
+		both is requested in the same wave. CRTC info is requested first so
+		that every active CRTC is in the cache by the time we learn which
+		outputs are connected, CRTCs shared by several outputs (mirroring)
+		are only kept once.
+
+		example:
+			fluke::Pipeline pipe{conn};
+			fluke::request_display_cache(pipe);
+			pipe.run();
+	*/
+	inline void request_display_cache(fluke::Pipeline& pipe) {
+		auto& conn = pipe.connection();
+		auto& displays = conn.displays();
+
+		displays.rebuild();
+
+		pipe.send(fluke::randr_get_screen_resources_current(conn, conn.root()), [&conn, &displays] (
+			fluke::Pipeline& queue, fluke::RandrGetScreenResourcesCurrentReply res
+		) {
+			if (not res) {
+				displays.commit();
+				return;
+			}
+
+			const auto crtcs = xcb_randr_get_screen_resources_current_crtcs(res.get());
+			const auto outputs = xcb_randr_get_screen_resources_current_outputs(res.get());
+			const auto modes = xcb_randr_get_screen_resources_current_modes(res.get());
+
+			for (int i = 0; i < xcb_randr_get_screen_resources_current_modes_length(res.get()); ++i)
+				displays.add_mode(modes[i]);
+
+			for (int i = 0; i < xcb_randr_get_screen_resources_current_crtcs_length(res.get()); ++i) {
+				const xcb_randr_crtc_t crtc = crtcs[i];
+
+				queue.send(fluke::randr_get_crtc_info(conn, crtc), [&displays, crtc] (auto&, fluke::RandrGetCrtcInfoReply info) {
+					// Skip CRTCs which aren't driving anything.
+					if (info and info->mode != XCB_NONE)
+						displays.add(fluke::Display{ crtc, fluke::as_rect(info) }, info->mode);
+				});
+			}
 
+			for (int i = 0; i < xcb_randr_get_screen_resources_current_outputs_length(res.get()); ++i) {
+				queue.send(fluke::randr_get_output_info(conn, outputs[i]), [&displays] (auto&, fluke::RandrGetOutputInfoReply info) {
+					if (info and fluke::is_connected(info) and info->crtc != XCB_NONE)
+						displays.connect(info->crtc);
+				});
+			}
+
+			queue.then([&conn, &displays] (auto&) {
+				displays.commit();
 
-		// Get CRTC structures.
-		return fluke::dispatch_consume(conn, [&conn] (const auto& info) {
-			return fluke::randr_get_crtc_info(conn, info->crtc);
-		}, output_info);
+				// The screen may have changed size, keep the spatial index
+				// of the window cache covering all of it.
+				if (displays.size() != 0)
+					conn.windows().resize_index(displays.bounds());
+			});
+		});
+	}
+
+
+
+	/*
+		Ask randr for the rects of all connected displays and store them
+		in the display cache.
+
+		example:
+			fluke::build_display_cache(conn);
+	*/
+	inline void build_display_cache(fluke::Connection& conn) {
+		fluke::Pipeline pipe{conn};
+		fluke::request_display_cache(pipe);
+		pipe.run();
+	}
+
+
+
+	/*
+		Returns the display cache, rebuilding it first if randr has told
+		us that the display topology has changed.
+
+		example:
+			for (const auto& [crtc, rect, refresh]: fluke::get_displays(conn))
+				std::cout << rect << '\n';
+	*/
+	inline const fluke::DisplayCache& get_displays(fluke::Connection& conn) {
+		if (not conn.displays().is_valid()) {
+			FLUKE_DEBUG_NOTICE_SUB("rebuilding display cache.")
+			fluke::build_display_cache(conn);
+		}
+
+		return conn.displays();
 	}
 
 
@@ -309,40 +535,83 @@ namespace fluke {
 
 
 	/*
-		Find the rect of a display which is nearest to provided rect.
+		Checks if a given point resides within the boundaries of a given
+		rectangle.
+
+		example:
+			bool is_inside = fluke::aabb({0, 0, 10, 10}, {5, 5});
+	*/
+	inline bool aabb(const fluke::Rect& r, const fluke::Point& p) {
+		const auto [x, y, w, h] = r;
+		const auto [px, py] = p;
+
+		return
+			px >= x and
+			py >= y and
+			px <= x + w and
+			py <= y + h
+		;
+	}
+
+
+
+	/*
+		Find the display which is nearest to provided rect.
 		Can be used to find the display that a window is on for example.
 
 		example:
-			auto [x, y, w, h] = get_nearest_display_rect(conn,
-				fluke::as_rect(fluke::get(conn,
-					fluke::get_geometry(conn, fluke::get_focused_window(conn))
-				))
-			);
+			auto [crtc, rect, refresh] = get_nearest_display(conn, client->rect);
 	*/
-	inline fluke::Rect get_nearest_display_rect(fluke::Connection& conn, const fluke::Rect& r) {
+	inline fluke::Display get_nearest_display(fluke::Connection& conn, const fluke::Rect& r) {
 		// Destructure rect argument.
 		const auto [x_, y_, w_, h_] = r;
 
 		// Get center of rect argument.
 		const fluke::Point center{ x_ + w_ / 2, y_ + h_ / 2 };
 
-		// Store distances to rects and the associated rect itself.
-		std::vector<std::pair<fluke::Rect, int>> distances;
+		const auto& displays = fluke::get_displays(conn);
 
-		// Loop over all displays and get its distance to `center`.
-		for (const auto& disp: fluke::get_crtcs(conn)) {
-			const auto [x, y, w, h] = fluke::as_rect(disp);
+		if (displays.size() == 0)
+			return fluke::Display{XCB_NONE, fluke::Rect{}};
 
-			distances.emplace_back(
-				fluke::Rect{x, y, w, h},
-				fluke::distance(center, fluke::Point{ x + w / 2, y + h / 2 })
-			);
+		// There are only ever a handful of displays so a scan over the cache
+		// beats any index, keep track of the nearest one as we go rather than
+		// collecting every distance.
+		const fluke::Display* nearest = nullptr;
+		auto nearest_dist = 0.0;
+
+		for (const auto& disp: displays) {
+			// Windows are almost always on a display, no need to measure.
+			if (fluke::aabb(disp.rect, center))
+				return disp;
+
+			const auto [x, y, w, h] = disp.rect;
+			const auto dist = fluke::distance(center, fluke::Point{ x + w / 2, y + h / 2 });
+
+			if (not nearest or dist < nearest_dist) {
+				nearest = &disp;
+				nearest_dist = dist;
+			}
 		}
 
-		// Find rect which is nearest and return it.
-		return std::min_element(distances.begin(), distances.end(), [] (const auto& a, const auto& b) {
-			return a.second < b.second;
-		})->first;
+		return *nearest;
+	}
+
+
+
+	/*
+		Find the rect of a display which is nearest to provided rect.
+		Can be used to find the display that a window is on for example.
+
+		example:
+			auto [x, y, w, h] = get_nearest_display_rect(conn,
+				fluke::as_rect(fluke::get(conn,
+					fluke::get_geometry(conn, fluke::get_focused_window(conn))
+				))
+			);
+	*/
+	inline fluke::Rect get_nearest_display_rect(fluke::Connection& conn, const fluke::Rect& r) {
+		return fluke::get_nearest_display(conn, r).rect;
 	}
 
 
@@ -394,43 +663,121 @@ namespace fluke {
 		We grab keys in a way that lets them work regardless of currently
 		active modifiers such as caps lock, scroll lock and num lock.
 
+		The keycode lookup table used by `event_keypress` is rebuilt here too
+		so this should be called again whenever the keyboard mapping changes.
+
+		Only grabs which differ from the previous call are sent. New grabs are
+		sent as one batch of checked requests which costs a single round trip
+		to verify, grabs which fail (usually because another client already
+		holds them) are reported.
+
 		example:
 			register_keybindings(conn, keys);
 	*/
 	template <size_t N>
 	inline void register_keybindings(fluke::Connection& conn, const fluke::Keys<N>& keys) {
-		// Toggleable modifiers.
-		constexpr std::array modifiers{
-			0u,
+		static_assert(N < fluke::KeyTable::none, "too many keybindings to fit in the keycode table!");
 
-			fluke::keys::caps_lock,
-			fluke::keys::num_lock,
-			fluke::keys::scroll_lock,
+		auto& table = conn.keytable();
 
-			fluke::keys::caps_lock | fluke::keys::num_lock,
-			fluke::keys::caps_lock | fluke::keys::scroll_lock,
-			fluke::keys::num_lock  | fluke::keys::scroll_lock,
 
-			fluke::keys::caps_lock | fluke::keys::num_lock | fluke::keys::scroll_lock,
-		};
+		// Get the keysyms of every keycode in one request rather than asking
+		// for the keycodes of each keybinding separately.
+		const auto setup = xcb_get_setup(conn);
+		const xcb_keycode_t min_keycode = setup->min_keycode;
+		const xcb_keycode_t max_keycode = setup->max_keycode;
+
+		const auto mapping = fluke::get(conn, fluke::get_keyboard_mapping(
+			conn, min_keycode, static_cast<uint8_t>(max_keycode - min_keycode + 1)
+		));
+
+		if (not mapping) {
+			tinge::errorln("could not get keyboard mapping!");
+			return;
+		}
+
+		const xcb_keysym_t* syms = xcb_get_keyboard_mapping_keysyms(mapping.get());
+		const size_t per_keycode = mapping->keysyms_per_keycode;
+		const size_t length = static_cast<size_t>(xcb_get_keyboard_mapping_keysyms_length(mapping.get()));
 
-		// Ungrab any keys which are already grabbed.
-		fluke::ungrab_key(conn, XCB_GRAB_ANY, conn.root(), XCB_MOD_MASK_ANY);
 
-		// Register our keybindings.
-		FLUKE_DEBUG_NOTICE_SUB("grab keys.")
-		for (const auto& [key_mod, key_keysym, key_func]: keys) {
-			for (const auto& keycode: fluke::get_keycodes(conn, key_keysym)) {
-				// Register the keybind under every modifier in the above structure.
+		// Work out which grabs we want. The lookup table is built on the
+		// side, the old one keeps working with the old grabs if we never
+		// get this far.
+		fluke::KeyTable lookup;
+		std::vector<fluke::KeyGrab> wanted;
+
+		for (size_t j = 0; j < length; ++j) {
+			const auto keycode = static_cast<xcb_keycode_t>(min_keycode + j / per_keycode);
+
+			if (syms[j] == XCB_NO_SYMBOL)
+				continue;
+
+			for (size_t i = 0; i < N; ++i) {
+				const auto& [key_mod, key_keysym, key_func] = keys[i];
+
+				if (key_keysym != syms[j])
+					continue;
+
+				lookup.insert(keycode, key_mod, i);
+
+				// Register the keybind under every combination of lock modifiers.
 				// This is so that our keybinding can work while various "locks" are
 				// active like caps lock.
-				// This will make X send us events for the registered bindings.
-				for (const auto& mod: modifiers)
-					fluke::grab_key(
-						conn, true, conn.root(), key_mod | mod, keycode, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC
-					);
+				for (const auto& mod: fluke::keys::lock_combinations)
+					wanted.emplace_back(fluke::KeyGrab{ keycode, static_cast<uint16_t>(key_mod | mod) });
 			}
 		}
+
+		std::sort(wanted.begin(), wanted.end());
+		wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+		lookup.grabs() = std::move(table.grabs());
+		table = std::move(lookup);
+
+
+		// Find the grabs which have been added or removed since last time.
+		auto& active = table.grabs();
+		std::vector<fluke::KeyGrab> added, removed;
+
+		std::set_difference(wanted.begin(), wanted.end(), active.begin(), active.end(), std::back_inserter(added));
+		std::set_difference(active.begin(), active.end(), wanted.begin(), wanted.end(), std::back_inserter(removed));
+
+		FLUKE_DEBUG_NOTICE_SUB(
+			"grab keys (", tinge::fg::make_yellow(added.size()), " added, ",
+			tinge::fg::make_yellow(removed.size()), " removed)."
+		)
+
+
+		// Ungrab keys which are no longer bound.
+		for (const auto& [keycode, mod]: removed)
+			fluke::ungrab_key(conn, keycode, conn.root(), mod);
+
+
+		// Send all new grabs before checking any of them so that they are pipelined.
+		std::vector<xcb_void_cookie_t> cookies;
+		cookies.reserve(added.size());
+
+		for (const auto& [keycode, mod]: added)
+			cookies.emplace_back(fluke::grab_key_checked(
+				conn, true, conn.root(), mod, keycode, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC
+			));
+
+
+		// Check the grabs, failed grabs are not remembered so they are tried again next time.
+		for (const auto& [grab, cookie]: fluke::zip(added, cookies)) {
+			if (const auto err = fluke::request_check(conn, cookie)) {
+				tinge::warnln(
+					"could not grab keycode '", tinge::fg::make_yellow(int(grab.keycode)),
+					"' with modifiers '", tinge::fg::make_yellow(fluke::to_hex(grab.mod)),
+					"' (", fluke::error_str[err->error_code], ")"
+				);
+
+				wanted.erase(std::lower_bound(wanted.begin(), wanted.end(), grab));
+			}
+		}
+
+		active = std::move(wanted);
 	}
 
 
@@ -447,6 +794,48 @@ namespace fluke {
 
 
 
+	/*
+		Send the values of a ConfigureRequest on to X unchanged.
+
+		example:
+			fluke::forward_configure_request(conn, *e);
+	*/
+	inline void forward_configure_request(fluke::Connection& conn, const xcb_configure_request_event_t& e) {
+		const uint16_t mask = e.value_mask;
+
+		// `values` here functions as a stack.
+		// We push values onto it depending on if a bitmask is satisfied
+		// for each possible option.
+		uint8_t i = 0;
+		std::array<uint32_t, 7> values{};
+
+		if (mask & XCB_CONFIG_WINDOW_X)            values[i++] = static_cast<uint32_t>(e.x);
+		if (mask & XCB_CONFIG_WINDOW_Y)            values[i++] = static_cast<uint32_t>(e.y);
+		if (mask & XCB_CONFIG_WINDOW_WIDTH)        values[i++] = e.width;
+		if (mask & XCB_CONFIG_WINDOW_HEIGHT)       values[i++] = e.height;
+		if (mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) values[i++] = e.border_width;
+		if (mask & XCB_CONFIG_WINDOW_SIBLING)      values[i++] = e.sibling;
+		if (mask & XCB_CONFIG_WINDOW_STACK_MODE)   values[i++] = e.stack_mode;
+
+		fluke::configure_window(conn, e.window, mask, values.data());
+	}
+
+
+
+	/*
+		Forward every paced ConfigureRequest whose refresh interval is over.
+
+		example:
+			fluke::forward_due_configure_requests(conn);
+	*/
+	inline void forward_due_configure_requests(fluke::Connection& conn) {
+		conn.pacer().take_due(fluke::ConfigurePacer::clock::now(), [&conn] (const auto& request) {
+			fluke::forward_configure_request(conn, request);
+		});
+	}
+
+
+
 	/*
 		Get the event type of a generic event structure.
 
@@ -530,22 +919,21 @@ namespace fluke {
 
 
 	/*
-		Checks if a given point resides within the boundaries of a given
-		rectangle.
+		Get the monitor which contains the pointer, the CRTC is
+		`XCB_NONE` if the pointer isn't on any monitor.
 
 		example:
-			bool is_inside = fluke::aabb({0, 0, 10, 10}, {5, 5});
+			auto [crtc, rect, refresh] = fluke::get_hovered_display(conn);
 	*/
-	inline bool aabb(const fluke::Rect& r, const fluke::Point& p) {
-		const auto [x, y, w, h] = r;
-		const auto [px, py] = p;
+	inline fluke::Display get_hovered_display(fluke::Connection& conn) {
+		const auto cursor = fluke::as_point(fluke::get(conn, fluke::query_pointer(conn, conn.root())));
 
-		return
-			px >= x and
-			py >= y and
-			px <= x + w and
-			py <= y + h
-		;
+		for (const auto& disp: fluke::get_displays(conn)) {
+			if (fluke::aabb(disp.rect, cursor))
+				return disp;
+		}
+
+		return fluke::Display{XCB_NONE, fluke::Rect{0, 0, 0, 0}};
 	}
 
 
@@ -557,16 +945,57 @@ namespace fluke {
 			auto [x, y, w, h] = fluke::get_hovered_monitor(conn);
 	*/
 	inline fluke::Rect get_hovered_display_rect(fluke::Connection& conn) {
-		const auto cursor = fluke::as_point(fluke::get(conn, fluke::query_pointer(conn, conn.root())));
+		return fluke::get_hovered_display(conn).rect;
+	}
+
+
 
-		for (const auto& disp: fluke::get_crtcs(conn)) {
-			const auto display_rect = fluke::as_rect(disp);
+	/*
+		Call `func(win)` for every window we keep hidden, the windows on
+		workspaces which aren't active and scratchpads which aren't shown.
+
+		example:
+			fluke::for_each_hidden_window(conn, [&conn] (xcb_window_t win) {
+				fluke::map_window(conn, win);
+			});
+	*/
+	template <typename F>
+	inline void for_each_hidden_window(fluke::Connection& conn, F&& func) {
+		conn.workspaces().for_each([&func] (auto, auto active, const auto& workspaces) {
+			for (size_t i = 0; i < workspaces.size(); ++i) {
+				if (i == active)
+					continue;
+
+				for (xcb_window_t win: workspaces[i])
+					func(win);
+			}
+		});
 
-			if (fluke::aabb(display_rect, cursor))
-				return display_rect;
+		for (size_t i = 0; i < conn.scratchpads().size(); ++i) {
+			const auto& slot = conn.scratchpads()[i];
+
+			if (slot.win != XCB_NONE and not slot.visible)
+				func(slot.win);
 		}
+	}
+
+
 
-		return fluke::Rect{0, 0, 0, 0};
+	/*
+		Hide a window which we are going to show again ourselves. It goes
+		in our save-set so that X maps it again if we go away without
+		doing so, otherwise it would be out of reach for good.
+
+		Workspace switches tell `fluke::Workspaces` to expect the unmap
+		before calling this so the window keeps its workspace.
+
+		example:
+			fluke::hide_window(conn, win);
+	*/
+	inline void hide_window(fluke::Connection& conn, xcb_window_t win) {
+		fluke::change_save_set(conn, XCB_SET_MODE_INSERT, win);
+		fluke::unmap_window(conn, win);
+		conn.windows().set_mapped(win, false);
 	}
 
 
@@ -583,6 +1012,84 @@ namespace fluke {
 
 
 
+	/*
+		Returns the mapped windows which are not ignored for every display,
+		indexed the same as `fluke::get_displays`. Each window is assigned to
+		the display `fluke::get_nearest_display` picks for it in a single
+		sweep over the window cache and is listed in stacking order, topmost
+		first.
+
+		example:
+			const auto& displays = fluke::get_displays(conn);
+			const auto per_display = fluke::get_mapped_windows_by_display(conn);
+
+			for (size_t i = 0; i < displays.size(); ++i)
+				std::cout << displays[i].rect << ' ' << per_display[i].size() << '\n';
+	*/
+	inline auto get_mapped_windows_by_display(fluke::Connection& conn) {
+		const auto& displays = fluke::get_displays(conn);
+
+		std::vector<std::vector<xcb_window_t>> windows(displays.size());
+
+		if (displays.size() == 0)
+			return windows;
+
+		for (auto it = conn.windows().rbegin(); it != conn.windows().rend(); ++it) {
+			const auto& [win, rect, mapped, ignored] = *it;
+
+			if (ignored or not mapped)
+				continue;
+
+			// Use the same rule as everything else which asks which display
+			// a window is on so that workspaces, trees and layouts agree.
+			const auto crtc = fluke::get_nearest_display(conn, rect).crtc;
+
+			for (size_t i = 0; i < displays.size(); ++i) {
+				if (displays[i].crtc == crtc) {
+					windows[i].emplace_back(win);
+					break;
+				}
+			}
+		}
+
+		return windows;
+	}
+
+
+
+	/*
+		Returns a vector of windows which are mapped, not ignored and are on
+		the display with the given rect. Callers which need the display
+		again pass it in so the pointer is only queried once.
+
+		example:
+			const auto display_rect = fluke::get_hovered_display_rect(conn);
+			auto windows = fluke::get_mapped_windows_on_display(conn, display_rect);
+	*/
+	inline auto get_mapped_windows_on_display(fluke::Connection& conn, const fluke::Rect& display_rect) {
+		std::vector<xcb_window_t> windows;
+		windows.reserve(conn.windows().size());
+
+		// Skip windows which have override_redirect set, are unmapped and
+		// which are not on the display.
+		for (auto it = conn.windows().rbegin(); it != conn.windows().rend(); ++it) {
+			const auto& [win, rect, mapped, ignored] = *it;
+
+			if (
+				ignored or
+				not mapped or
+				display_rect != fluke::get_nearest_display_rect(conn, rect)
+			)
+				continue;
+
+			windows.emplace_back(win);
+		}
+
+		return windows;
+	}
+
+
+
 	/*
 		Returns a vector of windows which are mapped, not ignored and are on
 		the same display as the mouse cursor.
@@ -594,41 +1101,7 @@ namespace fluke {
 				std::cout << fluke::to_hex(win) << '\n';
 	*/
 	inline auto get_mapped_windows_on_hovered_display(fluke::Connection& conn) {
-		// Get all windows.
-		auto windows = fluke::get_tree(conn);
-
-		// Get the geometry and attributes of all windows,
-		// each element in the returned vector is of type
-		// `std::tuple<fluke::GetWindowAttributesReply, fluke::GetGeometryReply>`.
-		const auto attrs_geoms = fluke::dispatch_consume(conn, [&conn] (xcb_window_t win) {
-			return std::tuple{
-				fluke::get_window_attributes(conn, win),
-				fluke::get_geometry(conn, win)
-			};
-		}, windows);
-
-
-		// Get the rect of the display which contains the mouse cursor.
-		auto hovered_rect = fluke::get_hovered_display_rect(conn);
-
-		// We use `i` to allow indexing `attrs_geoms` while simultaneously indexing `windows`.
-		decltype(attrs_geoms)::size_type i = 0;
-
-		// Remove windows which have override_redirect set, are unmapped and
-		// which are not on the same diplay as the pointer.
-		const auto should_remove = [&] (xcb_window_t win) {
-			const auto& [attr, geom] = attrs_geoms[i++];
-
-			return
-				fluke::is_ignored(attr) or
-				not fluke::is_mapped(attr) or
-				hovered_rect != fluke::get_nearest_display_rect(conn, fluke::as_rect(geom))
-			;
-		};
-
-		windows.erase(std::remove_if(windows.begin(), windows.end(), should_remove), windows.end());
-
-		return windows;
+		return fluke::get_mapped_windows_on_display(conn, fluke::get_hovered_display_rect(conn));
 	}
 
 
@@ -668,8 +1141,7 @@ namespace fluke {
 	*/
 	inline void center_window_on_hovered_display(fluke::Connection& conn, xcb_window_t win) {
 		// Get window geometry.
-		const auto [window_x, window_y, window_w, window_h] =
-			fluke::as_rect(fluke::get(conn, fluke::get_geometry(conn, win)));
+		const auto [window_x, window_y, window_w, window_h] = fluke::get_window_rect(conn, win);
 
 		// Get rect of focused display.
 		const auto [display_x, display_y, display_w, display_h] =
@@ -192,6 +192,24 @@ namespace fluke {
 		constexpr uint32_t eject       = 0x1008FF2C;
 		constexpr uint32_t screensaver = 0x1008FF2D;
 		constexpr uint32_t sleep       = 0x1008FF2F;
+
+
+		// Combinations of toggleable modifiers. Grabs are made under every
+		// one of these so that they work while caps lock, num lock or
+		// scroll lock are active.
+		constexpr std::array lock_combinations{
+			0u,
+
+			caps_lock,
+			num_lock,
+			scroll_lock,
+
+			caps_lock | num_lock,
+			caps_lock | scroll_lock,
+			num_lock  | scroll_lock,
+
+			caps_lock | num_lock | scroll_lock,
+		};
 	}
 }
 
@@ -0,0 +1,454 @@
+#ifndef FLUKE_LAYOUT_HPP
+#define FLUKE_LAYOUT_HPP
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+#include <cstdint>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Split `length` pixels starting at `start` into `count` parts and return
+		the offset and size of part `i`.
+
+		Leftover pixels are spread exactly with integer arithmetic so parts differ
+		in size by at most one pixel, they never overlap or leave gaps and always
+		add up to `length`. Unlike accumulating a float, the result for a given
+		part never changes by a pixel depending on rounding.
+
+		example:
+			const auto [y, h] = fluke::split_span(display_y, display_h, windows.size(), i);
+	*/
+	constexpr std::pair<int, int> split_span(const int start, const int length, const size_t count, const size_t i) {
+		const auto begin = (int64_t{length} * static_cast<int64_t>(i)) / static_cast<int64_t>(count);
+		const auto end = (int64_t{length} * static_cast<int64_t>(i + 1)) / static_cast<int64_t>(count);
+
+		return { start + static_cast<int>(begin), static_cast<int>(end - begin) };
+	}
+
+
+
+	/*
+		Pick the number of columns and rows for a grid of `count` cells
+		which makes the cells as close to square as possible on an area of
+		`w` by `h` pixels. The last row may not be full.
+
+		example:
+			const auto [cols, rows] = fluke::grid_dimensions(windows.size(), display_w, display_h);
+	*/
+	inline std::pair<size_t, size_t> grid_dimensions(const size_t count, const int w, const int h) {
+		if (count == 0 or w <= 0 or h <= 0)
+			return { 1, 1 };
+
+		// Square cells need cols / rows == w / h and cols * rows == count.
+		auto cols = static_cast<size_t>(std::ceil(std::sqrt(double(count) * w / h)));
+		cols = std::clamp<size_t>(cols, 1, count);
+
+		const size_t rows = (count + cols - 1) / cols;
+
+		// Drop columns which would be left empty.
+		cols = (count + rows - 1) / rows;
+
+		return { cols, rows };
+	}
+
+
+
+	/*
+		Fill in the rects of a grid layout over `area` for every placement in
+		`layout` in a single pass. The windows of the last row are stretched
+		to fill the row when it is not full.
+
+		example:
+			fluke::layout_grid(layout, display_rect);
+	*/
+	inline void layout_grid(std::vector<fluke::Placement>& layout, const fluke::Rect& area) {
+		const auto count = layout.size();
+		const auto [cols, rows] = fluke::grid_dimensions(count, area.w, area.h);
+
+		// Number of cells in the last row.
+		const size_t last_cols = count - (rows - 1) * cols;
+
+		for (size_t i = 0; i < count; ++i) {
+			const size_t row = i / cols;
+			const size_t col = i % cols;
+
+			const auto [y, h] = fluke::split_span(area.y, area.h, rows, row);
+			const auto [x, w] = fluke::split_span(area.x, area.w, row == rows - 1 ? last_cols : cols, col);
+
+			layout[i].rect = fluke::get_adjusted_window_rect(fluke::Rect{ x, y, w, h });
+		}
+	}
+
+
+
+	// Tiling
+	enum {
+		MASTER_LEFT,
+		MASTER_RIGHT,
+	};
+
+	constexpr const char* master_str[] = {
+		"MASTER_LEFT",
+		"MASTER_RIGHT",
+	};
+
+	/*
+		Fill in the rects of a master/slave layout over `area`. The `master`
+		window takes up `master_size` percent of the width on `master_side`
+		and the rest are stacked on top of each other on the other side.
+
+		example:
+			fluke::layout_masterslave(layout, display_rect, focused, fluke::MASTER_LEFT, 60);
+	*/
+	inline void layout_masterslave(
+		std::vector<fluke::Placement>& layout,
+		const fluke::Rect& area,
+		const xcb_window_t master,
+		const int master_side,
+		const int master_size
+	) {
+		const auto [display_x, display_y, display_w, display_h] = area;
+
+		// Get widths of master and slave windows.
+		const auto master_w = (display_w * master_size) / 100;
+		const auto slave_w = display_w - master_w;
+
+		// Slave windows are stacked on top of each other.
+		const bool has_master = std::any_of(layout.begin(), layout.end(), [master] (const auto& p) {
+			return p.win == master;
+		});
+
+		const size_t slave_count = layout.size() - (has_master ? 1 : 0);
+		size_t slave_index = 0;
+
+		for (auto& [win, rect]: layout) {
+			// Master window.
+			if (win == master) {
+				// Rectangle for master window.
+				rect = fluke::get_adjusted_window_rect( std::array{
+					fluke::Rect{ display_x, display_y, master_w, display_h },  // Left
+					fluke::Rect{ display_x + slave_w, display_y, master_w, display_h },  // Right
+				}.at(std::make_unsigned_t<int>(master_side)) );
+			}
+
+			// Slave windows.
+			else {
+				const auto [slave_y, slave_h] = fluke::split_span(display_y, display_h, slave_count, slave_index++);
+
+				// Rectangle for slave windows, opposite to `master_side`.
+				rect = fluke::get_adjusted_window_rect( std::array{
+					fluke::Rect{ display_x + master_w, slave_y, slave_w, slave_h },  // Right
+					fluke::Rect{ display_x, slave_y, slave_w, slave_h },  // Left
+				}.at(std::make_unsigned_t<int>(master_side)) );
+			}
+		}
+	}
+
+
+
+	/*
+		Fill in the rects of a monocle layout, every window covers `area`.
+
+		example:
+			fluke::layout_monocle(layout, display_rect);
+	*/
+	inline void layout_monocle(std::vector<fluke::Placement>& layout, const fluke::Rect& area) {
+		const auto full = fluke::get_adjusted_window_rect(area);
+
+		for (auto& [win, rect]: layout)
+			rect = full;
+	}
+
+
+
+	enum {
+		STACK_VERTICAL,
+		STACK_HORIZONTAL,
+	};
+
+	constexpr const char* stacked_str[] = {
+		"STACK_VERTICAL",
+		"STACK_HORIZONTAL",
+	};
+
+	/*
+		Fill in the rects of a stacked layout, windows split `area` evenly
+		either top to bottom or left to right.
+
+		example:
+			fluke::layout_stacked(layout, display_rect, fluke::STACK_VERTICAL);
+	*/
+	inline void layout_stacked(std::vector<fluke::Placement>& layout, const fluke::Rect& area, const int stack_dir) {
+		const auto [display_x, display_y, display_w, display_h] = area;
+
+		for (size_t i = 0; i < layout.size(); ++i) {
+			fluke::Rect new_rect;
+
+			if (stack_dir == STACK_VERTICAL) {
+				const auto [y, h] = fluke::split_span(display_y, display_h, layout.size(), i);
+				new_rect = fluke::Rect{ display_x, y, display_w, h };
+			}
+
+			else {
+				const auto [x, w] = fluke::split_span(display_x, display_w, layout.size(), i);
+				new_rect = fluke::Rect{ x, display_y, w, display_h };
+			}
+
+			layout[i].rect = fluke::get_adjusted_window_rect(new_rect);
+		}
+	}
+
+
+
+	/*
+		Move and resize windows to the rects computed by a layout.
+
+		The target rects are compared with the window cache and only the
+		fields which differ are sent to X, windows which are already in place
+		cost nothing. The cache is updated straight away rather than waiting
+		for the ConfigureNotify so that applying the same layout twice in a
+		row sends no requests the second time.
+
+		Returns the number of windows which were configured.
+
+		example:
+			std::vector<fluke::Placement> layout;
+
+			for (xcb_window_t win: fluke::get_mapped_windows_on_hovered_display(conn))
+				layout.emplace_back(fluke::Placement{ win, fluke::Rect{ 0, 0, 100, 100 } });
+
+			fluke::apply_layout(conn, layout);
+	*/
+	inline size_t apply_layout(fluke::Connection& conn, const std::vector<fluke::Placement>& layout) {
+		size_t configured = 0;
+
+		for (const auto& [win, rect]: layout) {
+			const auto client = conn.windows().find(win);
+
+			// Already in place.
+			if (client and client->rect == rect)
+				continue;
+
+			// Only send the fields which changed, every field is sent for
+			// windows we don't know about.
+			uint16_t mask = 0;
+			uint32_t values[4];
+			size_t n = 0;
+
+			const auto changed = [&] (const auto current, const auto target, const uint16_t field) {
+				if (client and current == target)
+					return;
+
+				mask |= field;
+				values[n++] = static_cast<uint32_t>(target);
+			};
+
+			const auto current = client ? client->rect : fluke::Rect{};
+
+			changed(current.x, rect.x, XCB_CONFIG_WINDOW_X);
+			changed(current.y, rect.y, XCB_CONFIG_WINDOW_Y);
+			changed(current.w, rect.w, XCB_CONFIG_WINDOW_WIDTH);
+			changed(current.h, rect.h, XCB_CONFIG_WINDOW_HEIGHT);
+
+			fluke::configure_window(conn, win, mask, values);
+			configured++;
+
+			if (client)
+				conn.windows().set_rect(win, rect);
+		}
+
+		FLUKE_DEBUG_NOTICE_SUB("configured ", configured, " of ", layout.size(), " windows.")
+
+		return configured;
+	}
+
+
+
+	/*
+		Apply the cells changed by a BSP tree operation, gaps and
+		borders are added here since the tree works with bare cells.
+
+		example:
+			std::vector<fluke::Placement> changed;
+			tree.remove(win, changed);
+			fluke::apply_bsp_layout(conn, changed);
+	*/
+	inline size_t apply_bsp_layout(fluke::Connection& conn, std::vector<fluke::Placement>& changed) {
+		for (auto& [win, rect]: changed)
+			rect = fluke::get_adjusted_window_rect(rect);
+
+		return fluke::apply_layout(conn, changed);
+	}
+
+
+
+	/*
+		Insert a window into the BSP tree of the display it is on if that
+		display is tiled. The window shares the cell of `target`, only the
+		windows in that cell are moved.
+
+		example:
+			fluke::tile_window(conn, win, fluke::get_focused_window(conn));
+	*/
+	inline void tile_window(fluke::Connection& conn, xcb_window_t win, xcb_window_t target) {
+		if (conn.tiling().empty())
+			return;
+
+		// Windows are tiled wherever they are, not wherever the pointer
+		// happens to be when they map.
+		const auto client = conn.windows().find(win);
+
+		const auto it = conn.tiling().find(client ?
+			fluke::get_nearest_display(conn, client->rect).crtc :
+			fluke::get_hovered_display(conn).crtc
+		);
+
+		if (it == conn.tiling().end())
+			return;
+
+		std::vector<fluke::Placement> changed;
+		it->second.insert(win, target, changed);
+
+		fluke::apply_bsp_layout(conn, changed);
+	}
+
+
+
+	/*
+		Remove a window from whichever BSP tree holds it, its sibling grows
+		to fill the space and nothing else is moved.
+
+		example:
+			fluke::untile_window(conn, win);
+	*/
+	inline void untile_window(fluke::Connection& conn, xcb_window_t win) {
+		for (auto& [crtc, tree]: conn.tiling()) {
+			if (not tree.contains(win))
+				continue;
+
+			std::vector<fluke::Placement> changed;
+			tree.remove(win, changed);
+
+			fluke::apply_bsp_layout(conn, changed);
+			return;
+		}
+	}
+
+
+
+	/*
+		Move the workspaces of displays which have gone away to a display
+		which is still there, otherwise windows on their inactive
+		workspaces could never be shown again. Each workspace is merged
+		into the workspace with the same index, windows are shown or hidden
+		to match whether that workspace is active.
+
+		example:
+			conn.displays().invalidate();
+			fluke::fit_workspaces_to_displays(conn);
+	*/
+	inline void fit_workspaces_to_displays(fluke::Connection& conn) {
+		const auto& displays = fluke::get_displays(conn);
+
+		// Every display is off, wait for one to come back.
+		if (displays.size() == 0)
+			return;
+
+		auto& workspaces = conn.workspaces();
+		std::vector<xcb_randr_crtc_t> vanished;
+
+		workspaces.for_each([&] (auto crtc, auto, const auto&) {
+			const bool exists = std::any_of(displays.begin(), displays.end(), [crtc] (const auto& d) {
+				return d.crtc == crtc;
+			});
+
+			if (not exists)
+				vanished.emplace_back(crtc);
+		});
+
+		const auto into = displays[0].crtc;
+
+		for (const auto crtc: vanished) {
+			std::vector<xcb_window_t> moved;
+
+			for (size_t i = 0; i < fluke::Workspaces::count; ++i) {
+				const auto& clients = workspaces.clients(crtc, i);
+				moved.insert(moved.end(), clients.begin(), clients.end());
+			}
+
+			workspaces.merge(crtc, into);
+
+			for (xcb_window_t win: moved) {
+				const auto client = conn.windows().find(win);
+
+				if (not client)
+					continue;
+
+				const bool hidden = workspaces.is_hidden(win);
+
+				if (not hidden and not client->mapped) {
+					fluke::map_window(conn, win);
+					conn.windows().set_mapped(win, true);
+				}
+
+				else if (hidden and client->mapped) {
+					workspaces.expect_unmap(win);
+					fluke::hide_window(conn, win);
+				}
+			}
+		}
+	}
+
+
+
+	/*
+		Bring the BSP trees in line with the displays after randr tells us
+		they changed. A tree whose display is gone is dropped and leaves its
+		windows where they are, a tree whose display moved or changed size
+		is laid out again over the new area.
+
+		example:
+			conn.displays().invalidate();
+			fluke::fit_tiling_to_displays(conn);
+	*/
+	inline void fit_tiling_to_displays(fluke::Connection& conn) {
+		if (conn.tiling().empty())
+			return;
+
+		const auto& displays = fluke::get_displays(conn);
+
+		for (auto it = conn.tiling().begin(); it != conn.tiling().end();) {
+			auto& [crtc, tree] = *it;
+
+			const auto disp = std::find_if(displays.begin(), displays.end(), [crtc = crtc] (const auto& d) {
+				return d.crtc == crtc;
+			});
+
+			if (disp == displays.end()) {
+				it = conn.tiling().erase(it);
+				continue;
+			}
+
+			const auto area = fluke::get_adjusted_display_rect(disp->rect);
+
+			if (area != tree.rect()) {
+				std::vector<fluke::Placement> changed;
+				tree.resize(area, changed);
+
+				fluke::apply_bsp_layout(conn, changed);
+			}
+
+			++it;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef FLUKE_PIPELINE_HPP
+#define FLUKE_PIPELINE_HPP
+
+#pragma once
+
+#include <array>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Sends requests of any kind and hands each reply to a callback as soon
+		as it arrives. Callbacks can send more requests on the same pipeline
+		which lets dependent requests (like asking for the geometry of every
+		child returned by `query_tree`) go out without waiting for every other
+		reply first.
+
+		Replies are consumed in the order the requests were sent, which is the
+		order X answers them in, so we only ever block on the oldest request.
+
+		Cookies and callbacks are stored in a fixed size ring on the stack.
+		When the ring is full, the oldest request is consumed to make room.
+		Callbacks are stored by value and must be small and trivially copyable,
+		in practice this means a lambda which captures a couple of references
+		or IDs. Callbacks are passed the pipeline and the reply.
+
+		Any requests still in flight are consumed when the pipeline is destroyed.
+
+		example:
+			fluke::Pipeline pipe{conn};
+
+			pipe.send(fluke::query_tree(conn, conn.root()), [&conn] (auto& queue, fluke::QueryTreeReply tree) {
+				const auto children = xcb_query_tree_children(tree.get());
+
+				for (int i = 0; i < xcb_query_tree_children_length(tree.get()); ++i) {
+					const xcb_window_t win = children[i];
+
+					queue.send(fluke::get_geometry(conn, win), [win] (auto&, fluke::GetGeometryReply geom) {
+						std::cout << fluke::to_hex(win) << ' ' << fluke::as_rect(geom) << '\n';
+					});
+				}
+			});
+
+			pipe.send(fluke::query_pointer(conn, conn.root()), [] (auto&, fluke::QueryPointerReply ptr) {
+				std::cout << fluke::as_point(ptr) << '\n';
+			});
+
+			pipe.run();
+	*/
+	class Pipeline {
+		// Constants
+		public:
+			// Maximum number of requests in flight.
+			static constexpr size_t capacity = 128;
+
+
+		private:
+			static constexpr size_t cookie_size = sizeof(unsigned);
+			static constexpr size_t handler_size = 3 * sizeof(void*);
+
+
+		// Types
+		private:
+			struct Entry {
+				void (*thunk)(Pipeline&, Entry&) = nullptr;
+
+				alignas(unsigned) std::byte cookie[cookie_size];
+				alignas(std::max_align_t) std::byte handler[handler_size];
+			};
+
+
+		// Data
+		private:
+			fluke::Connection& conn;
+
+			std::array<Entry, capacity> entries;
+
+			size_t head = 0;
+			size_t count = 0;
+
+			// Requests sent since we last flushed.
+			size_t unflushed = 0;
+
+
+		// Helpers
+		private:
+			template <typename F>
+			static constexpr void check_handler() {
+				static_assert(sizeof(F) <= handler_size, "pipeline callbacks should capture at most a few references");
+				static_assert(std::is_trivially_copyable_v<F>, "pipeline callbacks must be trivially copyable");
+				static_assert(alignof(F) <= alignof(std::max_align_t));
+			}
+
+
+			// Reserve the next slot in the ring. The callback of a popped
+			// request may send more requests and fill the ring again, keep
+			// popping until there really is a free slot.
+			Entry& push() {
+				while (count == capacity)
+					pop();
+
+				count++;
+				return entries[(head + count - 1) % capacity];
+			}
+
+
+			// Consume the oldest request. The entry is copied out first since
+			// the callback may send more requests which reuse its slot.
+			void pop() {
+				Entry entry = entries[head];
+
+				head = (head + 1) % capacity;
+				count--;
+
+				entry.thunk(*this, entry);
+			}
+
+
+		// Constructors
+		public:
+			explicit Pipeline(fluke::Connection& conn_):
+				conn(conn_) {}
+
+			~Pipeline() {
+				run();
+			}
+
+			Pipeline(const Pipeline&) = delete;
+			Pipeline& operator=(const Pipeline&) = delete;
+
+
+		// Functions
+		public:
+			fluke::Connection& connection() noexcept {
+				return conn;
+			}
+
+
+			/*
+				Queue `func` to be called with the reply to `cookie`.
+			*/
+			template <typename C, typename F>
+			void send(const C& cookie, F&& func) {
+				using H = std::decay_t<F>;
+
+				check_handler<H>();
+				static_assert(sizeof(C) <= cookie_size and std::is_trivially_destructible_v<C>);
+
+				auto& entry = push();
+
+				new (entry.cookie) C{cookie};
+				new (entry.handler) H{std::forward<F>(func)};
+
+				entry.thunk = [] (Pipeline& pipe, Entry& e) {
+					const auto& c = *std::launder(reinterpret_cast<const C*>(e.cookie));
+					auto& h = *std::launder(reinterpret_cast<H*>(e.handler));
+
+					h(pipe, fluke::get(pipe.conn, c));
+				};
+
+				// Flush regularly so that requests stream out while we consume
+				// older replies rather than waiting for the buffer to fill.
+				if (++unflushed >= capacity / 2) {
+					conn.flush();
+					unflushed = 0;
+				}
+			}
+
+
+			/*
+				Queue `func` to be called once every request sent before it
+				has been consumed. `func` is passed the pipeline.
+			*/
+			template <typename F>
+			void then(F&& func) {
+				using H = std::decay_t<F>;
+
+				check_handler<H>();
+
+				auto& entry = push();
+				new (entry.handler) H{std::forward<F>(func)};
+
+				entry.thunk = [] (Pipeline& pipe, Entry& e) {
+					auto& h = *std::launder(reinterpret_cast<H*>(e.handler));
+					h(pipe);
+				};
+			}
+
+
+			// Consume every request including the ones sent by callbacks.
+			void run() {
+				while (count != 0)
+					pop();
+
+				unflushed = 0;
+			}
+
+
+			auto size() const noexcept {
+				return count;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef FLUKE_RESTART_HPP
+#define FLUKE_RESTART_HPP
+
+#pragma once
+
+#include <string>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <signal.h>
+	#include <sys/mman.h>
+}
+
+
+namespace fluke {
+	/*
+		Replace the running fluke with a fresh copy of the binary at
+		`argv[0]`, for example to pick up a new config after rebuilding.
+
+		The state of the window manager is written to a snapshot in a
+		`memfd` which the new process inherits, it is told where to find it
+		with `--restore <fd>`. Nothing touches the disk and the new process
+		doesn't have to ask X about the windows it already knows.
+
+		Passive grabs and event selections belong to our X connection and
+		can't be handed over, so we let go of the root window, our keys and
+		our buttons before replacing ourselves and the new process takes
+		them again.
+		Windows, their stacking order and the input focus are left alone.
+
+		Only returns if the restart failed, in which case we take the root
+		window and our keys back and carry on as before.
+
+		example:
+			if (conn.restart_requested())
+				fluke::restart(conn, argv, fluke::config::keybindings);
+	*/
+	template <size_t N>
+	inline bool restart(fluke::Connection& conn, char* const argv[], const fluke::Keys<N>& keys) {
+		FLUKE_DEBUG_NOTICE("restarting '", tinge::fg::make_yellow(argv[0]), "'")
+
+		conn.request_restart(false);
+
+		// A replay has nothing to hand over.
+		if (conn.trace().replaying() or conn.trace().recording())
+			return false;
+
+		// Not close-on-exec, the new process needs this.
+		const int fd = memfd_create("fluke-snapshot", 0);
+
+		if (fd == -1)
+			return false;
+
+		if (not fluke::write_snapshot(conn, fd)) {
+			close(fd);
+			return false;
+		}
+
+		// Forward anything which is being paced, the new process starts
+		// with an empty pacer.
+		conn.pacer().take_all([&conn] (const auto& request) {
+			fluke::forward_configure_request(conn, request);
+		});
+
+		// Hidden windows stay hidden for the new process, which takes them
+		// into its own save-set.
+		fluke::for_each_hidden_window(conn, [&conn] (xcb_window_t win) {
+			fluke::change_save_set(conn, XCB_SET_MODE_DELETE, win);
+		});
+
+		// Only one client may redirect the root window and grab a key, make
+		// sure X has seen us let go before the new process asks for them.
+		fluke::ungrab_key(conn, XCB_GRAB_ANY, conn.root(), XCB_MOD_MASK_ANY);
+		fluke::ungrab_button(conn, XCB_BUTTON_INDEX_ANY, conn.root(), XCB_MOD_MASK_ANY);
+		fluke::ungrab_pointer(conn);
+		conn.drag().reset();
+		fluke::change_window_attributes(conn, conn.root(), XCB_CW_EVENT_MASK, XCB_EVENT_MASK_NO_EVENT);
+		conn.sync();
+
+		conn.keytable().grabs().clear();
+
+		// Our connection is close-on-exec, the new process opens its own.
+
+		const auto fd_arg = std::to_string(fd);
+		const char* const args[] = { argv[0], "--restore", fd_arg.c_str(), nullptr };
+
+		// The signals the event loop reads from a file are blocked and the
+		// mask survives exec, the new process would never see them if it
+		// couldn't set up its own loop.
+		sigset_t blocked;
+		const sigset_t* original = conn.loop().original_signal_mask();
+
+		if (original)
+			sigprocmask(SIG_SETMASK, original, &blocked);
+
+		execvp(args[0], const_cast<char* const*>(args));
+
+		// Still here, take everything back.
+		if (original)
+			sigprocmask(SIG_SETMASK, &blocked, nullptr);
+
+		tinge::errorln("cannot restart '", argv[0], "'!");
+
+		close(fd);
+
+		fluke::for_each_hidden_window(conn, [&conn] (xcb_window_t win) {
+			fluke::change_save_set(conn, XCB_SET_MODE_INSERT, win);
+		});
+
+		fluke::change_window_attributes(conn, conn.root(), XCB_CW_EVENT_MASK, fluke::XCB_WINDOWMANAGER_EVENTS);
+		fluke::register_keybindings(conn, keys);
+		fluke::register_buttons(conn);
+
+		return false;
+	}
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef FLUKE_UTILS_SCRATCHPADS_HPP
+#define FLUKE_UTILS_SCRATCHPADS_HPP
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <fluke.hpp>
+
+
+namespace fluke {
+	/*
+		Get the instance name from the WM_CLASS property of a window.
+
+		example:
+			if (fluke::get_window_instance(conn, win) == "scratchpad_term") { ... }
+	*/
+	inline std::string get_window_instance(fluke::Connection& conn, xcb_window_t win) {
+		const auto prop = fluke::get(conn, fluke::get_property(conn, false, win, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 64));
+
+		if (not prop)
+			return {};
+
+		// WM_CLASS holds the instance and class as two null terminated strings.
+		const auto value = static_cast<const char*>(xcb_get_property_value(prop.get()));
+		const auto length = static_cast<size_t>(xcb_get_property_value_length(prop.get()));
+
+		return std::string{ value, strnlen(value, length) };
+	}
+
+
+
+	/*
+		Stop waiting for the windows of scratchpads whose program has been
+		reaped, they are launched again the next time they are shown.
+
+		example:
+			fluke::forget_exited_scratchpads(conn);
+	*/
+	inline void forget_exited_scratchpads(fluke::Connection& conn) {
+		auto& pads = conn.scratchpads();
+
+		if (not pads.waiting_for_windows())
+			return;
+
+		for (size_t i = 0; i < pads.size(); ++i) {
+			if (not pads[i].launched or fluke::children().running(pads[i].pid))
+				continue;
+
+			FLUKE_DEBUG_NOTICE_SUB("scratchpad '", tinge::fg::make_yellow(fluke::config::scratchpads[i].instance), "' exited without a window.")
+			pads.release(i);
+		}
+	}
+
+
+
+	/*
+		Start the program of scratchpad `i` unless it is already running.
+
+		example:
+			fluke::launch_scratchpad(conn, 0);
+	*/
+	inline void launch_scratchpad(fluke::Connection& conn, size_t i) {
+		fluke::forget_exited_scratchpads(conn);
+
+		auto& slot = conn.scratchpads()[i];
+
+		if (slot.win != XCB_NONE or slot.launched)
+			return;
+
+		// Only wait for a window if the program actually started, otherwise
+		// the next toggle tries again.
+		if (const pid_t pid = fluke::exec_argv(fluke::config::scratchpads[i].command.data()); pid != -1)
+			conn.scratchpads().launched(i, pid);
+	}
+
+
+
+	/*
+		Start every configured scratchpad, call this from `on_launch` so that
+		the programs are ready by the time they are first shown.
+
+		example:
+			fluke::launch_scratchpads(conn);
+	*/
+	inline void launch_scratchpads(fluke::Connection& conn) {
+		for (size_t i = 0; i < fluke::config::scratchpads.size(); ++i)
+			fluke::launch_scratchpad(conn, i);
+	}
+
+
+
+	/*
+		Show scratchpad `i` on top of everything else and focus it.
+
+		example:
+			fluke::show_scratchpad(conn, 0);
+	*/
+	inline void show_scratchpad(fluke::Connection& conn, size_t i) {
+		auto& slot = conn.scratchpads()[i];
+
+		// Not running yet, show it as soon as its window turns up.
+		if (slot.win == XCB_NONE) {
+			slot.show_on_claim = true;
+			fluke::launch_scratchpad(conn, i);
+			return;
+		}
+
+		if (slot.visible)
+			return;
+
+		slot.visible = true;
+
+		fluke::map_window(conn, slot.win);
+		conn.windows().set_mapped(slot.win, true);
+
+		fluke::configure_window(conn, slot.win, XCB_CONFIG_WINDOW_STACK_MODE, XCB_STACK_MODE_ABOVE);
+		fluke::set_input_focus(conn, XCB_INPUT_FOCUS_PARENT, slot.win);
+	}
+
+
+
+	/*
+		Hide scratchpad `i` and give focus back to the last focused window on
+		the workspace underneath it.
+
+		example:
+			fluke::hide_scratchpad(conn, 0);
+	*/
+	inline void hide_scratchpad(fluke::Connection& conn, size_t i) {
+		auto& slot = conn.scratchpads()[i];
+		slot.show_on_claim = false;
+
+		if (slot.win == XCB_NONE or not slot.visible)
+			return;
+
+		slot.visible = false;
+
+		fluke::hide_window(conn, slot.win);
+
+		auto& workspaces = conn.workspaces();
+		const auto crtc = fluke::get_nearest_display(conn, slot.rect).crtc;
+		const auto& clients = workspaces.clients(crtc, workspaces.active(crtc));
+
+		if (not clients.empty())
+			fluke::set_input_focus(conn, XCB_INPUT_FOCUS_PARENT, clients.back());
+	}
+
+
+
+	/*
+		Check if a window which asked to be mapped belongs to a scratchpad
+		we launched. If it does, it is moved into place and kept hidden
+		until the scratchpad is shown.
+
+		Returns true if the window was claimed.
+
+		example:
+			if (fluke::claim_scratchpad(conn, win))
+				return;
+	*/
+	inline bool claim_scratchpad(fluke::Connection& conn, xcb_window_t win) {
+		auto& pads = conn.scratchpads();
+
+		fluke::forget_exited_scratchpads(conn);
+
+		if (not pads.waiting_for_windows())
+			return false;
+
+		const auto instance = fluke::get_window_instance(conn, win);
+
+		for (size_t i = 0; i < pads.size(); ++i) {
+			const auto& cfg = fluke::config::scratchpads[i];
+
+			if (not pads[i].launched or instance != cfg.instance)
+				continue;
+
+			// Center the window on the display it was created on.
+			const auto client = conn.windows().find(win);
+			const auto [x, y, w, h] = fluke::get_adjusted_display_rect(
+				client ? fluke::get_nearest_display_rect(conn, client->rect) : fluke::get_hovered_display_rect(conn)
+			);
+
+			const int pad_w = (w * cfg.width_percent) / 100;
+			const int pad_h = (h * cfg.height_percent) / 100;
+
+			const auto rect = fluke::get_adjusted_window_rect(fluke::Rect{
+				x + (w - pad_w) / 2, y + (h - pad_h) / 2, pad_w, pad_h
+			});
+
+			const bool show = pads[i].show_on_claim;
+			pads.claim(i, win, rect);
+
+			// It stays unmapped until shown, see `fluke::hide_window`.
+			fluke::change_save_set(conn, XCB_SET_MODE_INSERT, win);
+
+			fluke::apply_layout(conn, { fluke::Placement{ win, rect } });
+
+			if (show)
+				fluke::show_scratchpad(conn, i);
+
+			return true;
+		}
+
+		return false;
+	}
+}
+
+#endif
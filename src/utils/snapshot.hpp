@@ -0,0 +1,598 @@
+#ifndef FLUKE_SNAPSHOT_HPP
+#define FLUKE_SNAPSHOT_HPP
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <fluke.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+}
+
+
+namespace fluke {
+	/*
+		A snapshot of everything we know about the windows we manage, written
+		when fluke exits so that a new instance can take over without asking X
+		about every window again.
+
+		The snapshot holds the window cache in stacking order, the workspace
+		of every window in focus order, the active workspace of every
+		display, the scratchpads and the BSP trees. It is written to a
+		temporary file through a shared mapping and renamed into place, and
+		read back through a private read-only mapping. A snapshot is only used
+		once, it is deleted after it has been read.
+
+		Window ids only mean something to the X server which handed them
+		out. A snapshot file records the identity of its server, the root
+		window, the release number and a random token kept in a property of
+		the root window for as long as the server runs, and is ignored by
+		any other server. Snapshots handed over on restart through a `memfd`
+		come from the same connection and are not checked.
+
+		Layout:
+			Header
+			ClientRecord     (header.clients)
+			WorkspaceRecord  (header.workspace_windows)
+			DisplayRecord    (header.displays)
+			ScratchRecord    (header.scratchpads)
+			TreeRecord       (header.trees)
+			NodeRecord       (header.nodes, the nodes of each tree in order)
+
+		example:
+			fluke::save_snapshot(conn, fluke::snapshot_path().c_str(), identity);
+	*/
+	class Snapshot {
+		// Types
+		public:
+			struct Identity {
+				uint32_t root;
+				uint32_t release;
+				uint64_t session;
+
+				bool operator==(const Identity& other) const noexcept {
+					return root == other.root and release == other.release and session == other.session;
+				}
+			};
+
+			struct Header {
+				char magic[4];
+				uint32_t version;
+
+				Identity identity;
+
+				uint32_t clients;
+				uint32_t workspace_windows;
+				uint32_t displays;
+				uint32_t scratchpads;
+				uint32_t trees;
+				uint32_t nodes;
+			};
+
+			struct RectRecord {
+				int16_t x, y;
+				uint16_t w, h;
+			};
+
+			struct ClientRecord {
+				uint32_t win;
+				RectRecord rect;
+				uint8_t mapped;
+				uint8_t ignored;
+				uint8_t pad[2];
+			};
+
+			struct WorkspaceRecord {
+				uint32_t win;
+				uint32_t crtc;
+				uint32_t index;
+			};
+
+			struct DisplayRecord {
+				uint32_t crtc;
+				uint32_t active;
+			};
+
+			struct ScratchRecord {
+				uint32_t index;
+				uint32_t win;
+				RectRecord rect;
+				uint8_t visible;
+				uint8_t pad[3];
+			};
+
+			struct TreeRecord {
+				uint32_t crtc;
+				RectRecord area;
+				uint32_t root;
+				uint32_t last;
+				uint32_t nodes;
+			};
+
+			struct NodeRecord {
+				RectRecord rect;
+				uint32_t parent, first, second;
+				uint32_t win;
+				float ratio;
+				uint8_t vertical;
+				uint8_t pad[3];
+			};
+
+			static constexpr char magic[4] = {'F', 'L', 'K', 'S'};
+			static constexpr uint32_t version = 2;
+
+
+			// A view of `count` records in the mapping.
+			template <typename T>
+			struct Records {
+				const T* first = nullptr;
+				size_t count = 0;
+
+				const T* begin() const noexcept { return first; }
+				const T* end() const noexcept { return first + count; }
+				size_t size() const noexcept { return count; }
+			};
+
+
+			static RectRecord to_record(const fluke::Rect& r) noexcept {
+				return RectRecord{ r.x, r.y, r.w, r.h };
+			}
+
+			static fluke::Rect from_record(const RectRecord& r) noexcept {
+				return fluke::Rect{ r.x, r.y, r.w, r.h };
+			}
+
+
+		// Data
+		private:
+			std::unique_ptr<std::byte, detail::Unmap> mapping;
+
+			Records<ClientRecord> client_records;
+			Records<WorkspaceRecord> workspace_records;
+			Records<DisplayRecord> display_records;
+			Records<ScratchRecord> scratch_records;
+			Records<TreeRecord> tree_records;
+			Records<NodeRecord> node_records;
+
+
+		// Helpers
+		private:
+			size_t size() const noexcept {
+				return mapping.get_deleter().size;
+			}
+
+			// Take the next `count` records of type `T` starting at `offset`.
+			template <typename T>
+			bool take(size_t& offset, const uint32_t count, Records<T>& out) const {
+				const size_t bytes = sizeof(T) * count;
+
+				if (offset + bytes > size())
+					return false;
+
+				out = Records<T>{ reinterpret_cast<const T*>(mapping.get() + offset), count };
+				offset += bytes;
+
+				return true;
+			}
+
+
+		// Functions
+		public:
+			/*
+				Map and validate the snapshot at `path` which must have been
+				written for the server with the given `identity`. The file is
+				removed so that it can't be used twice.
+
+				The snapshot may be in a directory anyone can write to, it is
+				only read if it's a regular file owned by us which nobody else
+				can write to.
+			*/
+			bool load(const char* path, const Identity& identity) {
+				const int fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+
+				if (fd == -1)
+					return false;
+
+				struct stat st;
+
+				const bool trusted =
+					fstat(fd, &st) == 0 and S_ISREG(st.st_mode) and
+					st.st_uid == getuid() and (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+
+				if (trusted)
+					unlink(path);
+
+				const bool ok = trusted and load(fd) and header().identity == identity and identity.session != 0;
+				close(fd);
+
+				if (not ok)
+					mapping.reset();
+
+				return ok;
+			}
+
+
+			/*
+				Map and validate the snapshot in the open file `fd`, the file
+				descriptor can be closed afterwards.
+			*/
+			bool load(const int fd) {
+				struct stat st;
+				void* ptr = MAP_FAILED;
+
+				if (fstat(fd, &st) == 0 and static_cast<size_t>(st.st_size) >= sizeof(Header))
+					ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+				if (ptr == MAP_FAILED)
+					return false;
+
+				mapping = std::unique_ptr<std::byte, detail::Unmap>{
+					static_cast<std::byte*>(ptr), detail::Unmap{static_cast<size_t>(st.st_size)}
+				};
+
+				const auto hdr = reinterpret_cast<const Header*>(mapping.get());
+
+				if (std::memcmp(hdr->magic, magic, sizeof(magic)) != 0 or hdr->version != version) {
+					mapping.reset();
+					return false;
+				}
+
+				size_t offset = sizeof(Header);
+
+				const bool ok =
+					take(offset, hdr->clients, client_records) and
+					take(offset, hdr->workspace_windows, workspace_records) and
+					take(offset, hdr->displays, display_records) and
+					take(offset, hdr->scratchpads, scratch_records) and
+					take(offset, hdr->trees, tree_records) and
+					take(offset, hdr->nodes, node_records);
+
+				if (not ok)
+					mapping.reset();
+
+				return ok;
+			}
+
+
+			bool loaded() const noexcept {
+				return mapping != nullptr;
+			}
+
+			const Header& header() const noexcept {
+				return *reinterpret_cast<const Header*>(mapping.get());
+			}
+
+			const auto& clients() const noexcept { return client_records; }
+			const auto& workspaces() const noexcept { return workspace_records; }
+			const auto& displays() const noexcept { return display_records; }
+			const auto& scratchpads() const noexcept { return scratch_records; }
+			const auto& trees() const noexcept { return tree_records; }
+			const auto& nodes() const noexcept { return node_records; }
+	};
+
+
+
+	/*
+		Where the snapshot for this X display is kept.
+
+		example:
+			const auto path = fluke::snapshot_path();
+	*/
+	inline std::string snapshot_path() {
+		return fluke::runtime_path(".snapshot");
+	}
+
+
+
+	/*
+		The identity of the server we are connected to. The token is read
+		from the `_FLUKE_SESSION` property of the root window, the first
+		instance of fluke to run on a server makes one up and sets it. A new
+		server starts without the property so it never matches a snapshot
+		written for an old one.
+
+		example:
+			const auto identity = fluke::snapshot_identity(conn);
+	*/
+	inline fluke::Snapshot::Identity snapshot_identity(fluke::Connection& conn) {
+		const auto setup = xcb_get_setup(conn);
+		fluke::Snapshot::Identity identity{ conn.root(), setup->release_number, 0 };
+
+		const auto atom = fluke::get(conn, fluke::intern_atom(conn, false, "_FLUKE_SESSION"));
+
+		if (not atom)
+			return identity;
+
+		const auto prop = fluke::get(conn, fluke::get_property(conn, false, conn.root(), atom->atom, XCB_ATOM_CARDINAL, 0, 2));
+
+		if (prop and prop->format == 32 and xcb_get_property_value_length(prop.get()) == sizeof(uint32_t[2])) {
+			const auto value = static_cast<const uint32_t*>(xcb_get_property_value(prop.get()));
+			identity.session = (static_cast<uint64_t>(value[0]) << 32) | value[1];
+		}
+
+		if (identity.session != 0)
+			return identity;
+
+		const auto now = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+		identity.session = (now ^ (static_cast<uint64_t>(getpid()) << 32)) | 1;
+
+		const uint32_t value[2] = { static_cast<uint32_t>(identity.session >> 32), static_cast<uint32_t>(identity.session) };
+		fluke::change_property(conn, XCB_PROP_MODE_REPLACE, conn.root(), atom->atom, XCB_ATOM_CARDINAL, 32, 2, value);
+
+		return identity;
+	}
+
+
+
+	/*
+		Write the state of the window manager to the open file `fd`, which
+		is resized to fit. Snapshots handed over through a `memfd` leave
+		`identity` empty.
+
+		example:
+			fluke::write_snapshot(conn, fd);
+	*/
+	inline bool write_snapshot(fluke::Connection& conn, const int fd, const fluke::Snapshot::Identity& identity = {}) {
+		using S = fluke::Snapshot;
+
+		std::vector<S::ClientRecord> clients;
+		std::vector<S::WorkspaceRecord> workspace_windows;
+		std::vector<S::DisplayRecord> displays;
+		std::vector<S::ScratchRecord> scratchpads;
+		std::vector<S::TreeRecord> trees;
+		std::vector<S::NodeRecord> nodes;
+
+		clients.reserve(conn.windows().size());
+
+		for (const auto& [win, rect, mapped, ignored]: conn.windows())
+			clients.emplace_back(S::ClientRecord{ win, S::to_record(rect), mapped, ignored, {} });
+
+		conn.workspaces().for_each([&] (auto crtc, auto active, const auto& workspaces) {
+			displays.emplace_back(S::DisplayRecord{ crtc, static_cast<uint32_t>(active) });
+
+			for (size_t i = 0; i < workspaces.size(); ++i) {
+				for (xcb_window_t win: workspaces[i])
+					workspace_windows.emplace_back(S::WorkspaceRecord{ win, crtc, static_cast<uint32_t>(i) });
+			}
+		});
+
+		for (size_t i = 0; i < conn.scratchpads().size(); ++i) {
+			const auto& slot = conn.scratchpads()[i];
+
+			if (slot.win != XCB_NONE)
+				scratchpads.emplace_back(S::ScratchRecord{ static_cast<uint32_t>(i), slot.win, S::to_record(slot.rect), slot.visible, {} });
+		}
+
+		for (const auto& [crtc, tree]: conn.tiling()) {
+			trees.emplace_back(S::TreeRecord{
+				crtc, S::to_record(tree.rect()),
+				tree.root_index(), tree.last_index(),
+				static_cast<uint32_t>(tree.data().size())
+			});
+
+			for (const auto& node: tree.data()) {
+				nodes.emplace_back(S::NodeRecord{
+					S::to_record(node.rect), node.parent, node.first, node.second,
+					node.win, node.ratio, node.vertical, {}
+				});
+			}
+		}
+
+		const S::Header header{
+			{S::magic[0], S::magic[1], S::magic[2], S::magic[3]}, S::version, identity,
+			static_cast<uint32_t>(clients.size()),
+			static_cast<uint32_t>(workspace_windows.size()),
+			static_cast<uint32_t>(displays.size()),
+			static_cast<uint32_t>(scratchpads.size()),
+			static_cast<uint32_t>(trees.size()),
+			static_cast<uint32_t>(nodes.size()),
+		};
+
+		const auto bytes = [] (const auto& v) {
+			return v.size() * sizeof(v[0]);
+		};
+
+		const size_t total =
+			sizeof(S::Header) + bytes(clients) + bytes(workspace_windows) + bytes(displays) +
+			bytes(scratchpads) + bytes(trees) + bytes(nodes);
+
+		void* ptr = MAP_FAILED;
+
+		if (ftruncate(fd, static_cast<off_t>(total)) == 0)
+			ptr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		if (ptr == MAP_FAILED)
+			return false;
+
+		auto out = static_cast<std::byte*>(ptr);
+
+		const auto put = [&out] (const void* data, const size_t length) {
+			if (length != 0)
+				std::memcpy(out, data, length);
+
+			out += length;
+		};
+
+		put(&header, sizeof(header));
+		put(clients.data(), bytes(clients));
+		put(workspace_windows.data(), bytes(workspace_windows));
+		put(displays.data(), bytes(displays));
+		put(scratchpads.data(), bytes(scratchpads));
+		put(trees.data(), bytes(trees));
+		put(nodes.data(), bytes(nodes));
+
+		munmap(ptr, total);
+
+		return true;
+	}
+
+
+
+	/*
+		Write the state of the window manager to a snapshot at `path` for
+		the server with the given `identity`.
+
+		example:
+			fluke::save_snapshot(conn, fluke::snapshot_path().c_str(), identity);
+	*/
+	inline bool save_snapshot(fluke::Connection& conn, const char* path, const fluke::Snapshot::Identity& identity) {
+		// Write to a temporary file and rename it over the snapshot so a new
+		// instance never sees a half written file. The temporary file is
+		// always created by us, never opened through whatever someone else
+		// left in its place.
+		const std::string tmp = std::string{path} + ".tmp";
+		unlink(tmp.c_str());
+
+		const int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+
+		if (fd == -1)
+			return false;
+
+		const bool ok = fluke::write_snapshot(conn, fd, identity);
+		close(fd);
+
+		if (not ok) {
+			unlink(tmp.c_str());
+			return false;
+		}
+
+		return std::rename(tmp.c_str(), path) == 0;
+	}
+
+
+
+	/*
+		Fill the window cache from a snapshot. A single `query_tree` tells us
+		which of the windows in the snapshot still exist, only windows which
+		weren't there when the snapshot was taken are asked about one by one.
+
+		example:
+			fluke::Pipeline pipe{conn};
+			fluke::request_window_cache(pipe, snapshot);
+			pipe.run();
+	*/
+	inline void request_window_cache(fluke::Pipeline& pipe, const fluke::Snapshot& snapshot) {
+		auto& conn = pipe.connection();
+		auto& cache = conn.windows();
+
+		cache.clear();
+
+		pipe.send(fluke::query_tree(conn, conn.root()), [&cache, &snapshot] (fluke::Pipeline& queue, fluke::QueryTreeReply tree) {
+			if (not tree)
+				return;
+
+			std::unordered_map<xcb_window_t, const fluke::Snapshot::ClientRecord*> saved;
+			saved.reserve(snapshot.clients().size());
+
+			for (const auto& record: snapshot.clients())
+				saved.emplace(record.win, &record);
+
+			// Children are returned bottom-most first which is the order the cache keeps them in.
+			const auto children = xcb_query_tree_children(tree.get());
+			const auto length = xcb_query_tree_children_length(tree.get());
+
+			for (int i = 0; i < length; ++i) {
+				const xcb_window_t win = children[i];
+				const auto it = saved.find(win);
+
+				if (it != saved.end()) {
+					const auto& record = *it->second;
+
+					cache.insert(fluke::Client{
+						win, fluke::Snapshot::from_record(record.rect), record.mapped != 0, record.ignored != 0
+					});
+
+					continue;
+				}
+
+				// Created while no window manager was running. A placeholder
+				// keeps its place in the stack until the replies arrive.
+				cache.insert(fluke::Client{ win, fluke::Rect{}, false, false });
+				fluke::request_window(queue, cache, win);
+			}
+		});
+	}
+
+
+
+	/*
+		Restore workspaces, scratchpads and BSP trees from a snapshot. Only
+		windows which are in the window cache are restored.
+
+		example:
+			fluke::restore_snapshot(conn, snapshot);
+	*/
+	inline void restore_snapshot(fluke::Connection& conn, const fluke::Snapshot& snapshot) {
+		const auto known = [&conn] (const xcb_window_t win) {
+			return conn.windows().find(win) != nullptr;
+		};
+
+		for (const auto& [win, crtc, index]: snapshot.workspaces()) {
+			if (known(win))
+				conn.workspaces().place(win, crtc, index);
+		}
+
+		for (const auto& [crtc, active]: snapshot.displays())
+			conn.workspaces().activate(crtc, active);
+
+		for (const auto& record: snapshot.scratchpads()) {
+			if (record.index >= conn.scratchpads().size() or not known(record.win))
+				continue;
+
+			conn.scratchpads().claim(record.index, record.win, fluke::Snapshot::from_record(record.rect));
+			conn.scratchpads()[record.index].visible = record.visible != 0;
+		}
+
+		const auto* node = snapshot.nodes().begin();
+
+		for (const auto& record: snapshot.trees()) {
+			std::vector<fluke::BspTree::Node> tree_nodes;
+			tree_nodes.reserve(record.nodes);
+
+			bool complete = true;
+
+			for (uint32_t i = 0; i < record.nodes; ++i, ++node) {
+				if (node == snapshot.nodes().end())
+					return;
+
+				fluke::BspTree::Node n;
+
+				n.rect = fluke::Snapshot::from_record(node->rect);
+				n.parent = node->parent;
+				n.first = node->first;
+				n.second = node->second;
+				n.win = node->win;
+				n.ratio = node->ratio;
+				n.vertical = node->vertical != 0;
+
+				// A tiled window disappeared, start this tree from scratch.
+				if (n.is_leaf() and n.win != XCB_NONE and not known(n.win))
+					complete = false;
+
+				tree_nodes.emplace_back(n);
+			}
+
+			if (not complete)
+				continue;
+
+			fluke::BspTree tree;
+
+			if (tree.restore(fluke::Snapshot::from_record(record.area), std::move(tree_nodes), record.root, record.last))
+				conn.tiling().emplace(record.crtc, std::move(tree));
+		}
+	}
+}
+
+#endif
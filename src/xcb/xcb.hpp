@@ -9,6 +9,7 @@
 
 extern "C" {
 #include <xcb/xcb.h>
+#include <xcb/xcbext.h>
 #include <xcb/xcb_aux.h>
 #include <xcb/xcb_atom.h>
 #include <xcb/xcb_icccm.h>
@@ -45,6 +46,11 @@ namespace fluke {
 		// XCB_EVENT_MASK_POINTER_MOTION
 	;
 
+	// Added to every selection of pointer motion, see `config::MOTION_HINTS`.
+	constexpr uint32_t XCB_MOTION_HINT_MASK =
+		fluke::config::MOTION_HINTS ? XCB_EVENT_MASK_POINTER_MOTION_HINT : 0
+	;
+
 	constexpr uint32_t XCB_WINDOW_EVENTS =
 		XCB_EVENT_MASK_ENTER_WINDOW |
 		XCB_EVENT_MASK_LEAVE_WINDOW |